@@ -0,0 +1,65 @@
+/*
+ * bench_call_overhead.cpp
+ *
+ *  per call cost of small message send/recv through Tmpl::BufferedSocket
+ *  over a unix datagram socketpair. the syscalls are the same in every
+ *  build, what differs is the call into the library and the status and
+ *  type checks around them.
+ *
+ *  built three times from this file:
+ *    bench_call_overhead         calls into libbylsocket.so
+ *    bench_call_overhead_inline  BYLSOCKET_HEADER_ONLY, templates inlined
+ *    bench_call_overhead_lto     static library with LTO (BYLSOCKET_LTO=ON)
+ *
+ *  usage: bench_call_overhead [iterations]
+ */
+#include "../src/tmpl_socket.h"
+#include "../src/metrics.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::BufferedSocket;
+
+typedef BufferedSocket<Domain::UNIX, Type::DGRAM> Dgram;
+
+#ifdef BYLSOCKET_HEADER_ONLY
+static const char *MODE = "header only";
+#elif defined(BYLSOCKET_BENCH_LTO)
+static const char *MODE = "static + lto";
+#else
+static const char *MODE = "shared library";
+#endif
+
+//! best of 5 runs, ns per iteration
+template<class F>
+static double best_ns(int iterations, F f) {
+    double best = 1e18;
+    for (int run = 0; run < 5; ++run) {
+        uint64_t t0 = now_ns();
+        for (int i = 0; i < iterations; ++i)
+            f();
+        best = std::min(best, (double) (now_ns() - t0) / iterations);
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, sv) == -1)
+        err_report_and_throw("socketpair");
+    Dgram a(Socket<Domain::UNIX, Type::DGRAM>(sv[0], Status::CONNECTED));
+    Dgram b(Socket<Domain::UNIX, Type::DGRAM>(sv[1], Status::CONNECTED));
+
+    double roundtrip = best_ns(iterations, [&]() {
+        a.send("16 byte message");
+        b.recv();
+    });
+    b.set_fmt_nul(false);
+    double formatted = best_ns(iterations, [&]() {
+        b.send_fmt("seq {} ok", 12345);
+        a.recv();
+    });
+    printf("%-16s send+recv %8.1f ns   send_fmt+recv %8.1f ns\n",
+           MODE, roundtrip, formatted);
+    return 0;
+}
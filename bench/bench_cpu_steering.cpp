@@ -0,0 +1,125 @@
+/*
+ * bench_cpu_steering.cpp
+ *
+ *  short lived loopback tcp connections against CpuListeners, once per
+ *  Steering: connections/s and round trips/s, how many connections were
+ *  served on another cpu than their packets arrived on (foreign) or had
+ *  to be handed on between threads, and the cache misses per round trip
+ *  (perf hardware counter of the whole process, n/a where the kernel or
+ *  the vm doesn't expose it).
+ *
+ *  the client threads are pinned round robin to the cpus, so the
+ *  connections arrive spread over all of them. steerings the kernel
+ *  can't do fall back, the mode actually used is printed.
+ *
+ *  usage: bench_cpu_steering [seconds per mode] [round trips per connection]
+ *                            [message bytes] [client threads]
+ */
+#include "../src/cpu_steering.h"
+#include "../src/busy_poll.h"
+#include "../src/metrics.h"
+#include "../src/transport.h"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::CpuListeners;
+
+typedef Socket<Domain::IP4, Type::STREAM> Tcp;
+
+static const char *name(Steering s) {
+    switch (s) {
+        case Steering::CBPF:
+            return "cbpf";
+        case Steering::INCOMING_CPU:
+            return "incoming_cpu";
+        default:
+            return "none";
+    }
+}
+
+//! cache misses of this process and the threads it starts from now on, -1 if n/a
+static int open_cache_misses() {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.inherit = 1;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+static void echo(int fd, EventLoop &loop) {
+    loop.add(fd, EPOLLIN, [fd, &loop](uint32_t) {
+        char buf[16 << 10];
+        ssize_t n = ::recv(fd, buf, sizeof buf, MSG_DONTWAIT);
+        if (n > 0) {
+            write_full(fd, buf, n);
+            return;
+        }
+        if (n == -1 && (errno == EAGAIN || errno == EINTR))
+            return;
+        loop.remove(fd);
+        close(fd);
+    });
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2;
+    int trips = argc > 2 ? atoi(argv[2]) : 16;
+    size_t msg_size = argc > 3 ? (size_t) atoi(argv[3]) : 256;
+    int ncpu = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = argc > 4 ? atoi(argv[4]) : ncpu;
+
+    printf("%d cpus, %d client threads, %d round trips of %zu bytes per connection\n",
+           ncpu, threads, trips, msg_size);
+    printf("%-13s %10s %12s %9s %10s %14s\n", "steering", "conns/s", "trips/s",
+           "foreign%", "handed%", "misses/trip");
+    const Steering modes[] = {Steering::CBPF, Steering::INCOMING_CPU, Steering::NONE};
+    for (Steering want : modes) {
+        int perf = open_cache_misses();
+        if (perf != -1)
+            ioctl(perf, PERF_EVENT_IOC_ENABLE, 0);
+        CpuListeners<Domain::IP4> group("50005", "127.0.0.1", echo, 0, want);
+
+        std::atomic<uint64_t> conns(0), done_trips(0);
+        uint64_t deadline = now_ns() + (uint64_t) (seconds * 1e9);
+        std::vector<std::thread> clients;
+        for (int t = 0; t < threads; ++t)
+            clients.emplace_back([&, t]() {
+                pin_thread(t % ncpu);
+                std::string msg(msg_size, 'c');
+                std::vector<char> buf(msg_size);
+                while (now_ns() < deadline) {
+                    Tcp c;
+                    c.connect("127.0.0.1", "50005");
+                    for (int i = 0; i < trips; ++i) {
+                        write_full(c.fd(), msg.data(), msg.size());
+                        read_full(c.fd(), buf.data(), buf.size());
+                    }
+                    ++conns;
+                    done_trips += trips;
+                }
+            });
+        for (auto &c : clients)
+            c.join();
+
+        long long misses = -1;
+        if (perf != -1) {
+            if (read(perf, &misses, sizeof misses) != sizeof misses)
+                misses = -1;
+            close(perf);
+        }
+        auto s = group.stats();
+        char per_trip[32] = "n/a";
+        if (misses >= 0)
+            snprintf(per_trip, sizeof per_trip, "%.0f", (double) misses / done_trips);
+        printf("%-13s %10.0f %12.0f %8.1f%% %9.1f%% %14s\n", name(group.steering()),
+               conns / seconds, done_trips / seconds,
+               s.served ? 100.0 * s.foreign / s.served : 0.0,
+               s.served ? 100.0 * s.handed_on / s.served : 0.0, per_trip);
+    }
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * bench_idle_connections.cpp
+ *
+ *  user space memory per idle connection held in a ConnectionTable.
+ *
+ *  a forked child opens n unix stream connections to the parent, which
+ *  accepts them into the table and an epoll set (data.u64 = handle), and
+ *  reports the rss growth per connection. then every k-th connection
+ *  sends a line so buffers get attached, consumed and handed back.
+ *
+ *  both processes need n fds, RLIMIT_NOFILE is raised to its hard limit
+ *  and n is clamped to fit.
+ *
+ *  usage: bench_idle_connections [connections] [active_every]
+ */
+#include "../src/tmpl_socket.h"
+#include "../src/connection_table.h"
+#include "../src/metrics.h"
+#include "../src/transport.h"
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+static const char *NAME = "bylsocket_bench_idle";
+
+static long rss_kb() {
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f)
+        return 0;
+    char line[256];
+    long kb = 0;
+    while (fgets(line, sizeof line, f))
+        if (sscanf(line, "VmRSS: %ld kB", &kb) == 1)
+            break;
+    fclose(f);
+    return kb;
+}
+
+//! connect n times, every k-th connection says hello once told to via ctl
+static void client(int n, int every, int ctl) {
+    std::vector<Socket<Domain::UNIX, Type::STREAM>> conns(n);
+    for (auto &c : conns)
+        c.connect(NAME);
+    char c;
+    read_full(ctl, &c, 1);
+    for (int i = 0; i < n; i += every)
+        write_full(conns[i].fd(), "hello\n", 6);
+    // hold the connections until the parent is done
+    read_full(ctl, &c, 1);
+    _exit(0);
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 200000;
+    int every = argc > 2 ? atoi(argv[2]) : 100;
+
+    rlimit rl;
+    getrlimit(RLIMIT_NOFILE, &rl);
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    if (rl.rlim_cur != RLIM_INFINITY && (rlim_t) n + 64 > rl.rlim_cur) {
+        n = (int) rl.rlim_cur - 64;
+        printf("RLIMIT_NOFILE is %lu, using %d connections\n",
+               (unsigned long) rl.rlim_cur, n);
+    }
+
+    ListenedSocket<Domain::UNIX> srv(NAME);
+    int lfd = srv.fd();
+    int flags = fcntl(lfd, F_GETFL);
+    if (flags == -1 || fcntl(lfd, F_SETFL, flags | O_NONBLOCK) == -1)
+        err_report_and_throw("fcntl");
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = ConnectionTable::INVALID;
+    epoll_ctl(ep, EPOLL_CTL_ADD, lfd, &ev);
+
+    int ctl[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, ctl) < 0)
+        err_report_and_throw("socketpair");
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(ctl[0]);
+        client(n, every, ctl[1]);
+    }
+    close(ctl[1]);
+
+    BufferPool pool(4096, 64);
+    ConnectionTable table(pool);
+    const int MAX_EVENTS = 1024;
+    epoll_event events[MAX_EVENTS];
+    long rss0 = rss_kb();
+    uint64_t t0 = now_ns();
+
+    while (table.size() < (size_t) n) {
+        int k = epoll_wait(ep, events, MAX_EVENTS, 5000);
+        if (k <= 0)
+            err_report_and_throw("accept stalled");
+        int fd;
+        while (table.size() < (size_t) n
+               && (fd = accept4(lfd, nullptr, nullptr,
+                                SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.u64 = table.open(fd);
+            epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+        }
+    }
+    double secs = (now_ns() - t0) / 1e9;
+    long rss1 = rss_kb();
+    printf("%zu connections accepted in %.2fs\n", table.size(), secs);
+    printf("  rss growth         %8ld kB, %6.1f bytes/connection\n",
+           rss1 - rss0, (rss1 - rss0) * 1024.0 / n);
+    printf("  table              %8zu kB, %6.1f bytes/connection\n",
+           table.memory_bytes() >> 10, (double) table.memory_bytes() / n);
+
+    // wake every k-th connection, read its line and let it go idle again
+    write_full(ctl[0], "g", 1);
+    size_t expect = (size_t) (n + every - 1) / every, lines = 0, peak = 0;
+    while (lines < expect) {
+        int k = epoll_wait(ep, events, MAX_EVENTS, 5000);
+        if (k <= 0)
+            err_report_and_throw("activity stalled");
+        for (int i = 0; i < k; ++i) {
+            ConnectionTable::Handle h = events[i].data.u64;
+            if (!table.valid(h))
+                continue;
+            // EOF, an error or ENOBUFS: a line longer than the buffer
+            ssize_t r = table.fill(h);
+            if (r == 0 || (r < 0 && errno != EAGAIN)) {
+                table.close(h);
+                continue;
+            }
+            peak = std::max(peak, table.buffers_in_use());
+            const char *d = table.data(h);
+            const char *nl = d ? (const char *) memchr(d, '\n',
+                                                       table.buffered(h))
+                               : nullptr;
+            if (nl) {
+                table.consume(h, nl - d + 1);
+                ++lines;
+            }
+        }
+    }
+    long rss2 = rss_kb();
+    printf("%zu active connections served, peak %zu buffers, "
+           "%zu left attached\n", lines, peak, table.buffers_in_use());
+    printf("  rss growth         %8ld kB, %6.1f bytes/connection\n",
+           rss2 - rss0, (rss2 - rss0) * 1024.0 / n);
+
+    write_full(ctl[0], "q", 1);
+    waitpid(pid, nullptr, 0);
+    close(ctl[0]);
+    close(ep);
+    return 0;
+}
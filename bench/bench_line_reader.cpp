@@ -0,0 +1,76 @@
+/*
+ * bench_line_reader.cpp
+ *
+ *  delimiter scanning throughput: find_byte vs the naive byte loop
+ *  vs libc memchr, over newline separated records of several lengths,
+ *  plus LineReader end to end over a unix socket.
+ */
+#include "../src/tmpl_socket.h"
+#include "../src/line_reader.h"
+#include "../src/transport.h"
+#include <iostream>
+#include <vector>
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+typedef std::chrono::steady_clock Clock;
+
+static const char *libc_memchr(const char *p, size_t n, char c) {
+    return static_cast<const char *>(memchr(p, c, n));
+}
+
+template<typename Find>
+static double scan_gbps(const std::vector<char> &buf, Find find, int rounds) {
+    size_t lines = 0;
+    auto t0 = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        const char *p = buf.data(), *end = p + buf.size();
+        while (const char *hit = find(p, end - p, '\n')) {
+            p = hit + 1;
+            ++lines;
+        }
+    }
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    if (!lines)
+        puts("no line found");
+    return buf.size() * (double) rounds / sec / 1e9;
+}
+
+static double reader_gbps(const std::vector<char> &buf) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_bench_line_reader");
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect("bylsocket_bench_line_reader");
+    auto conn = srv.accept();
+    std::thread writer([&]() {
+        for (int r = 0; r < 8; ++r)
+            write_full(cli.fd(), buf.data(), buf.size());
+        shutdown(cli.fd(), SHUT_WR);
+    });
+    LineReader reader(conn.fd());
+    Slice line;
+    size_t bytes = 0;
+    auto t0 = Clock::now();
+    while (reader.read_line(line))
+        bytes += line.size + 1;
+    double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+    writer.join();
+    return bytes / sec / 1e9;
+}
+
+int main() {
+    const size_t total = 16 << 20;
+    printf("%8s %10s %10s %10s %12s\n",
+           "linelen", "naive", "find_byte", "memchr", "LineReader");
+    for (size_t len : {16, 64, 256, 4096}) {
+        std::vector<char> buf(total, 'a');
+        for (size_t i = len - 1; i < total; i += len)
+            buf[i] = '\n';
+        int rounds = 8;
+        printf("%8zu %9.2fG %9.2fG %9.2fG %11.2fG\n", len,
+               scan_gbps(buf, find_byte_scalar, rounds),
+               scan_gbps(buf, find_byte, rounds),
+               scan_gbps(buf, libc_memchr, rounds),
+               reader_gbps(buf));
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * bench_pingpong.cpp
+ *
+ *  round trip latency of 64 byte messages over loopback tcp and unix
+ *  sockets, blocking recv vs BusyPoller (spin-then-park), both ends
+ *  pinned to their own cpu when there are enough of them.
+ *
+ *  usage: bench_pingpong [rounds]
+ */
+#include "../src/tmpl_socket.h"
+#include "../src/busy_poll.h"
+#include "../src/metrics.h"
+#include "../src/transport.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+static const size_t MSG = 64;
+
+template<Domain D>
+static void pingpong(const char *title, ListenedSocket<D> &srv,
+                     Socket<D, Type::STREAM> &cli, int rounds, bool spin) {
+    unsigned ncpu = std::thread::hardware_concurrency();
+    std::thread echo([&]() {
+        if (ncpu > 1)
+            pin_thread(1);
+        auto conn = srv.accept();
+        if (spin)
+            conn.set_opt(Options::BUSY_POLL, 50);
+        BusyPoller bp;
+        char buf[MSG];
+        for (int i = 0; i < rounds; ++i) {
+            for (size_t got = 0; got < MSG;) {
+                ssize_t n = spin ? bp.recv(conn.fd(), buf + got, MSG - got)
+                                 : ::recv(conn.fd(), buf + got, MSG - got, 0);
+                if (n <= 0)
+                    return;
+                got += n;
+            }
+            write_full(conn.fd(), buf, MSG);
+        }
+    });
+    if (ncpu > 1)
+        pin_thread(0);
+    if (spin)
+        cli.set_opt(Options::BUSY_POLL, 50);
+    BusyPoller bp;
+    Histogram h;
+    char buf[MSG] = {0};
+    for (int i = 0; i < rounds; ++i) {
+        uint64_t t0 = now_ns();
+        write_full(cli.fd(), buf, MSG);
+        for (size_t got = 0; got < MSG;) {
+            ssize_t n = spin ? bp.recv(cli.fd(), buf + got, MSG - got)
+                             : ::recv(cli.fd(), buf + got, MSG - got, 0);
+            if (n <= 0)
+                err_report_and_throw("recv");
+            got += n;
+        }
+        h.record(now_ns() - t0);
+    }
+    echo.join();
+    char t[64];
+    snprintf(t, sizeof t, "%-5s %-8s rtt(us)", title, spin ? "spin" : "blocking");
+    h.print(stdout, t);
+    if (spin)
+        printf("%14s spin_hits=%llu parks=%llu empty_polls=%llu\n", "",
+               (unsigned long long) bp.stats().spin_hits,
+               (unsigned long long) bp.stats().parks,
+               (unsigned long long) bp.stats().empty_polls);
+}
+
+int main(int argc, char *argv[]) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    if (std::thread::hardware_concurrency() < 2)
+        puts("note: single cpu, spinning competes with the peer");
+    for (bool spin : {false, true}) {
+        {
+            ListenedSocket<Domain::IP4> srv("50002");
+            Socket<Domain::IP4, Type::STREAM> cli;
+            cli.connect("127.0.0.1", "50002");
+            pingpong("tcp", srv, cli, rounds, spin);
+        }
+        {
+            ListenedSocket<Domain::UNIX> srv("bylsocket_bench_pingpong");
+            Socket<Domain::UNIX, Type::STREAM> cli;
+            cli.connect("bylsocket_bench_pingpong");
+            pingpong("unix", srv, cli, rounds, spin);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * bench_pipeline.cpp
+ *
+ *  request throughput of one PipelinedClient connection over loopback tcp
+ *  against the pipeline depth (max requests in flight). depth 1 is the
+ *  classic send-then-recv client, capped at 1/rtt.
+ *
+ *  the echo server reads whatever arrived and answers all complete
+ *  frames with a single write, like a pipelining aware server would.
+ *
+ *  requests are issued by several caller threads sharing the connection,
+ *  req/write shows how many of them went out per write syscall.
+ *
+ *  usage: bench_pipeline [requests per depth] [payload bytes] [callers]
+ */
+#include "../src/tmpl_socket.h"
+#include "../src/pipeline.h"
+#include "../src/metrics.h"
+#include "../src/transport.h"
+#include <atomic>
+#include <netinet/tcp.h>
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+static void echo_frames(int fd) {
+    std::vector<char> in(256 << 10);
+    std::string out;
+    size_t have = 0;
+    for (;;) {
+        ssize_t n = ::recv(fd, &in[have], in.size() - have, 0);
+        if (n <= 0)
+            return;
+        have += n;
+        size_t off = 0;
+        while (have - off >= 4) {
+            uint32_t len;
+            memcpy(&len, &in[off], 4);
+            len = ntohl(len);
+            if (have - off < 4 + (size_t) len) {
+                // grow for a frame larger than the buffer
+                if (4 + (size_t) len > in.size())
+                    in.resize(4 + (size_t) len);
+                break;
+            }
+            out.append(&in[off], 4 + len);
+            off += 4 + len;
+        }
+        memmove(&in[0], &in[off], have - off);
+        have -= off;
+        if (!out.empty()) {
+            write_full(fd, out.data(), out.size());
+            out.clear();
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int requests = argc > 1 ? atoi(argv[1]) : 100000;
+    size_t payload = argc > 2 ? (size_t) atoi(argv[2]) : 64;
+    int callers = argc > 3 ? atoi(argv[3]) : 4;
+
+    ListenedSocket<Domain::IP4> srv("50003");
+    std::string req(payload, 'x');
+    printf("%d callers, %zu byte requests\n", callers, payload);
+    printf("%6s %12s %10s %12s\n", "depth", "req/s", "MB/s", "req/write");
+    for (size_t depth = 1; depth <= 256; depth *= 2) {
+        // a fresh connection per depth, the client shuts its own down
+        Socket<Domain::IP4, Type::STREAM> cli;
+        cli.connect("127.0.0.1", "50003");
+        auto conn = srv.accept();
+        int one = 1;
+        setsockopt(cli.fd(), IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        setsockopt(conn.fd(), IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        std::thread server(echo_frames, conn.fd());
+
+        std::unique_ptr<PipelinedClient> pc(new PipelinedClient(cli.fd(), depth));
+        std::atomic<int> done(0);
+        uint64_t t0 = now_ns();
+        std::vector<std::thread> threads;
+        for (int k = 0; k < callers; ++k)
+            threads.emplace_back([&]() {
+                for (int i = 0; i < requests / callers; ++i)
+                    pc->call(req.data(), req.size(), [&done](int err, std::string &&) {
+                        if (!err)
+                            ++done;
+                    });
+            });
+        for (auto &t : threads)
+            t.join();
+        while (pc->in_flight())
+            std::this_thread::yield();
+        double secs = (now_ns() - t0) / 1e9;
+        printf("%6zu %12.0f %10.1f %12.2f\n", depth, done / secs,
+               done * payload * 2 / secs / 1e6,
+               (double) pc->requests() / pc->writes());
+        pc.reset();
+        server.join();
+    }
+    return 0;
+}
@@ -0,0 +1,457 @@
+/*
+ * loadgen.cpp
+ *
+ *  connection load generator and soak tester.
+ *
+ *  N connections over any Domain/Type send fixed size requests to an echo
+ *  server, either
+ *   closed: next request right after the previous response
+ *   open:   at a fixed aggregate rate regardless of responses, latency is
+ *           taken from the intended send time so stalls aren't hidden
+ *           (coordinated omission)
+ *   churn:  connect, one round trip, close, as fast as possible
+ *  and report throughput plus latency histograms every interval and at
+ *  the end. --serve runs the echo server in process.
+ *
+ *  usage: bylsocket-loadgen [--serve] [--domain ip4|ip6|unix]
+ *         [--type stream|dgram|seqpacket] [--addr A] [--port P]
+ *         [--conns N] [--threads T] [--mode closed|open|churn]
+ *         [--rate R] [--size B] [--duration S] [--interval S]
+ */
+
+#include "../src/byl_socket.hpp"
+#include "../src/event_loop.h"
+#include "../src/metrics.h"
+#include "../src/outbound_queue.h"
+#include "../src/transport.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/un.h>
+using namespace bylSocket;
+
+struct Config {
+    Domain domain = Domain::IP4;
+    Type type = Type::STREAM;
+    std::string addr;
+    std::string port = "50001";
+    int conns = 16;
+    int threads = 1;
+    std::string mode = "closed";
+    double rate = 10000;
+    size_t size = 64;
+    double duration = 10;
+    double interval = 1;
+    bool serve = false;
+};
+
+static std::atomic<bool> g_stop(false);
+//! the server outlives the clients so shutdown isn't counted as errors
+static std::atomic<bool> g_server_stop(false);
+
+static void set_nonblock(int fd) {
+    int fl = fcntl(fd, F_GETFL);
+    if (fl == -1 || fcntl(fd, F_SETFL, fl | O_NONBLOCK) == -1)
+        err_report_and_throw("fcntl");
+}
+
+static Socket make_client(const Config &c) {
+    Socket s(c.domain, c.type);
+    if (c.domain == Domain::UNIX && c.type == Type::DGRAM) {
+        // autobind: an unnamed socket can't be replied to
+        struct sockaddr_un a;
+        a.sun_family = AF_UNIX;
+        if (::bind(s.fd(), (sockaddr *) &a, sizeof a.sun_family) == -1)
+            err_report_and_throw("bind");
+    }
+    s.connect(c.addr.c_str(), c.port.c_str());
+    return s;
+}
+
+//! echo server on one event loop thread
+static void serve(const Config &c, std::atomic<bool> &ready) {
+    EventLoop loop;
+    std::vector<char> buf(64 << 10);
+    if (c.type == Type::DGRAM) {
+        Socket s(c.domain, Type::DGRAM);
+        s.bind(c.addr.c_str(), c.port.c_str());
+        ready = true;
+        loop.add(s.fd(), EPOLLIN, [&](uint32_t) {
+            struct sockaddr_storage from;
+            socklen_t len = sizeof from;
+            ssize_t n = recvfrom(s.fd(), buf.data(), buf.size(), MSG_DONTWAIT,
+                                 (sockaddr *) &from, &len);
+            if (n > 0)
+                sendto(s.fd(), buf.data(), n, 0, (sockaddr *) &from, len);
+        });
+        while (!g_server_stop)
+            loop.run_once(100);
+        return;
+    }
+    Socket ls(c.domain, c.type);
+    if (c.domain != Domain::UNIX) {
+        ls.set_opt(Options::REUSEADDR);
+        ls.set_opt(Options::REUSEPORT);
+    }
+    ls.bind(c.addr.c_str(), c.port.c_str());
+    ls.listen(SOMAXCONN);
+    set_nonblock(ls.fd());
+    ready = true;
+
+    struct Conn {
+        Socket sock;
+        OutboundQueue q;
+        uint32_t events = EPOLLIN;
+        Conn(Socket s) : sock(s), q(sock.fd()) {}
+    };
+    std::vector<std::unique_ptr<Conn>> conns;
+    // no reading while paused, or level triggered EPOLLIN spins the loop
+    auto watch = [&](int fd) {
+        Conn &cn = *conns[fd];
+        uint32_t want = (cn.q.paused() ? 0u : (uint32_t) EPOLLIN)
+                        | (cn.q.empty() ? 0u : (uint32_t) EPOLLOUT);
+        if (want != cn.events)
+            loop.modify(fd, want);
+        cn.events = want;
+    };
+    loop.add(ls.fd(), EPOLLIN, [&](uint32_t) {
+        int fd;
+        while ((fd = ::accept4(ls.fd(), nullptr, nullptr,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+            if ((size_t) fd >= conns.size())
+                conns.resize(fd + 1);
+            conns[fd].reset(new Conn(Socket(fd, c.domain, c.type,
+                                            Status::CONNECTED)));
+            conns[fd]->q.on_high([&, fd]() { watch(fd); });
+            conns[fd]->q.on_low([&, fd]() { watch(fd); });
+            loop.add(fd, EPOLLIN, [&, fd](uint32_t ev) {
+                Conn &cn = *conns[fd];
+                bool closed = (ev & (EPOLLERR | EPOLLHUP)) != 0;
+                try {
+                    if (ev & EPOLLOUT)
+                        cn.q.flush();
+                    // paused: nothing read, which is neither eof nor error
+                    while (!closed && !cn.q.paused()) {
+                        ssize_t n = ::recv(fd, buf.data(), buf.size(),
+                                           MSG_DONTWAIT);
+                        if (n > 0) {
+                            cn.q.send(buf.data(), n);
+                            continue;
+                        }
+                        if (n == 0 || errno != EAGAIN)
+                            closed = true;
+                        break;
+                    }
+                    if (!closed)
+                        watch(fd);
+                } catch (std::exception &) {
+                    closed = true;
+                }
+                if (closed) {
+                    loop.remove(fd);
+                    conns[fd].reset();
+                }
+            });
+        }
+    });
+    while (!g_server_stop)
+        loop.run_once(100);
+}
+
+struct Stats {
+    std::mutex mtx;
+    Histogram interval, total, connect_ns;
+    uint64_t requests = 0;
+    uint64_t connects = 0;
+    uint64_t errors = 0;
+};
+
+struct Client {
+    explicit Client(Socket s) : sock(s) {}
+    Socket sock;
+    std::string out;
+    std::vector<char> in;
+    size_t got = 0;
+    //! send times (open loop: intended) of outstanding requests
+    std::deque<uint64_t> sent;
+    uint64_t next_due = 0;
+    size_t unsent = 0;
+};
+
+static void record(Stats &st, uint64_t lat) {
+    std::lock_guard<std::mutex> g(st.mtx);
+    st.interval.record(lat);
+    st.total.record(lat);
+    ++st.requests;
+}
+
+/**
+ * @return false when the connection broke
+ */
+static bool write_some(Client &cl) {
+    while (cl.unsent) {
+        const char *p = cl.out.data() + cl.out.size() - cl.unsent;
+        ssize_t n = ::send(cl.sock.fd(), p, cl.unsent,
+                           MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0)
+            return errno == EAGAIN;
+        cl.unsent -= n;
+    }
+    return true;
+}
+
+static bool read_some(Client &cl, const Config &c, Stats &st) {
+    for (;;) {
+        ssize_t n = ::recv(cl.sock.fd(), cl.in.data() + cl.got,
+                           cl.in.size() - cl.got, MSG_DONTWAIT);
+        if (n < 0)
+            return errno == EAGAIN;
+        if (n == 0)
+            return false;
+        // datagrams are whole, stream bytes add up to whole responses
+        cl.got = c.type == Type::STREAM ? cl.got + n : c.size;
+        if (cl.got < c.size)
+            continue;
+        cl.got = 0;
+        if (cl.sent.empty())
+            continue;
+        record(st, now_ns() - cl.sent.front());
+        cl.sent.pop_front();
+    }
+}
+
+static void run_requests(const Config &c, int nconns, Stats &st) {
+    EventLoop loop;
+    std::vector<std::unique_ptr<Client>> clients;
+    const bool open = c.mode == "open";
+    // each connection's share of the aggregate rate
+    uint64_t period = open ? (uint64_t) (1e9 * c.conns / c.rate) : 0;
+    uint64_t start = now_ns();
+    for (int i = 0; i < nconns; ++i) {
+        std::unique_ptr<Client> cl(new Client(make_client(c)));
+        set_nonblock(cl->sock.fd());
+        cl->out.assign(c.size, 'x');
+        cl->in.resize(std::max(c.size, (size_t) 1));
+        // spread the first sends over one period
+        cl->next_due = start + (period * i) / std::max(nconns, 1);
+        clients.push_back(std::move(cl));
+    }
+    auto fire = [&](Client &cl, uint64_t stamp) {
+        if (cl.unsent)
+            return;
+        cl.sent.push_back(stamp);
+        cl.unsent = c.size;
+    };
+    for (auto &p : clients) {
+        Client *cl = p.get();
+        loop.add(cl->sock.fd(), EPOLLIN, [&, cl](uint32_t ev) {
+            bool ok = !(ev & EPOLLERR) && read_some(*cl, c, st)
+                      && write_some(*cl);
+            if (ok && !open && cl->sent.empty()) {
+                fire(*cl, now_ns());
+                ok = write_some(*cl);
+            }
+            if (!ok) {
+                std::lock_guard<std::mutex> g(st.mtx);
+                ++st.errors;
+                loop.remove(cl->sock.fd());
+            }
+        });
+        if (!open) {
+            fire(*cl, now_ns());
+            write_some(*cl);
+        }
+    }
+    while (!g_stop) {
+        int timeout = 100;
+        if (open) {
+            uint64_t now = now_ns();
+            uint64_t earliest = UINT64_MAX;
+            for (auto &p : clients) {
+                Client &cl = *p;
+                if (!loop.watching(cl.sock.fd()))
+                    continue;
+                // late sends keep their intended time
+                while (cl.next_due <= now && !cl.unsent) {
+                    fire(cl, cl.next_due);
+                    cl.next_due += period;
+                    write_some(cl);
+                }
+                earliest = std::min(earliest, cl.next_due);
+            }
+            if (earliest != UINT64_MAX)
+                timeout = earliest > now ? (int) ((earliest - now) / 1000000)
+                                         : 0;
+            timeout = std::min(timeout, 100);
+        }
+        loop.run_once(timeout);
+    }
+}
+
+static void run_churn(const Config &c, Stats &st) {
+    std::vector<char> buf(std::max(c.size, (size_t) 1));
+    std::string out(c.size, 'x');
+    while (!g_stop) {
+        try {
+            uint64_t t0 = now_ns();
+            Socket s = make_client(c);
+            uint64_t t1 = now_ns();
+            write_full(s.fd(), out.data(), out.size());
+            if (c.type == Type::STREAM)
+                read_full(s.fd(), buf.data(), c.size);
+            else if (::recv(s.fd(), buf.data(), buf.size(), 0) <= 0)
+                err_report_and_throw("recv");
+            uint64_t t2 = now_ns();
+            std::lock_guard<std::mutex> g(st.mtx);
+            st.connect_ns.record(t1 - t0);
+            st.interval.record(t2 - t0);
+            st.total.record(t2 - t0);
+            ++st.connects;
+            ++st.requests;
+        } catch (std::exception &) {
+            std::lock_guard<std::mutex> g(st.mtx);
+            ++st.errors;
+        }
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [--serve] [--domain ip4|ip6|unix] "
+            "[--type stream|dgram|seqpacket]\n"
+            "       [--addr A] [--port P] [--conns N] [--threads T] "
+            "[--mode closed|open|churn]\n"
+            "       [--rate R] [--size B] [--duration S] [--interval S]\n",
+            prog);
+    exit(1);
+}
+
+static Config parse(int argc, char *argv[]) {
+    Config c;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--serve") {
+            c.serve = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            usage(argv[0]);
+        std::string v = argv[++i];
+        if (a == "--domain")
+            c.domain = v == "unix" ? Domain::UNIX
+                     : v == "ip6" ? Domain::IP6 : Domain::IP4;
+        else if (a == "--type")
+            c.type = v == "dgram" ? Type::DGRAM
+                   : v == "seqpacket" ? Type::SEQPACKET : Type::STREAM;
+        else if (a == "--addr") c.addr = v;
+        else if (a == "--port") c.port = v;
+        else if (a == "--conns") c.conns = std::max(1, atoi(v.c_str()));
+        else if (a == "--threads") c.threads = std::max(1, atoi(v.c_str()));
+        else if (a == "--mode") c.mode = v;
+        else if (a == "--rate") c.rate = atof(v.c_str());
+        else if (a == "--size") c.size = std::max(1, atoi(v.c_str()));
+        else if (a == "--duration") c.duration = atof(v.c_str());
+        else if (a == "--interval") c.interval = atof(v.c_str());
+        else usage(argv[0]);
+    }
+    if (c.addr.empty())
+        c.addr = c.domain == Domain::UNIX ? "bylsocket_loadgen"
+               : c.domain == Domain::IP6 ? "::1" : "127.0.0.1";
+    if (c.mode != "closed" && c.mode != "open" && c.mode != "churn")
+        usage(argv[0]);
+    if (c.type == Type::DGRAM && c.mode == "open")
+        fprintf(stderr, "note: lost datagrams stay outstanding in open mode\n");
+    c.threads = std::min(c.threads, c.conns);
+    return c;
+}
+
+int main(int argc, char *argv[]) {
+    Config c = parse(argc, argv);
+    std::thread server;
+    if (c.serve) {
+        std::atomic<bool> ready(false);
+        server = std::thread([&]() {
+            try {
+                serve(c, ready);
+            } catch (std::exception &e) {
+                err_report(e.what());
+                exit(1);
+            }
+        });
+        while (!ready)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::vector<std::unique_ptr<Stats>> stats;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < c.threads; ++t) {
+        stats.emplace_back(new Stats);
+        int n = c.conns / c.threads + (t < c.conns % c.threads);
+        Stats &st = *stats.back();
+        workers.emplace_back([&c, &st, n]() {
+            try {
+                if (c.mode == "churn")
+                    run_churn(c, st);
+                else
+                    run_requests(c, n, st);
+            } catch (std::exception &e) {
+                err_report(e.what());
+                std::lock_guard<std::mutex> g(st.mtx);
+                ++st.errors;
+            }
+        });
+    }
+
+    uint64_t start = now_ns(), last = start;
+    uint64_t end = start + (uint64_t) (c.duration * 1e9);
+    Histogram total, connect_ns;
+    uint64_t requests = 0, connects = 0, errors = 0;
+    while (now_ns() < end) {
+        std::this_thread::sleep_for(std::chrono::microseconds(
+                (int64_t) (std::min(c.interval, (end - now_ns()) / 1e9) * 1e6)));
+        Histogram iv;
+        uint64_t req = 0;
+        for (auto &st : stats) {
+            std::lock_guard<std::mutex> g(st->mtx);
+            iv.merge(st->interval);
+            st->interval.reset();
+            req += st->requests;
+        }
+        uint64_t now = now_ns();
+        char title[96];
+        snprintf(title, sizeof title, "[%7.1fs] %10.0f req/s latency(us)",
+                 (now - start) / 1e9, (req - requests) / ((now - last) / 1e9));
+        iv.print(stdout, title);
+        fflush(stdout);
+        requests = req;
+        last = now;
+    }
+    g_stop = true;
+    for (auto &w : workers)
+        w.join();
+    requests = 0;
+    for (auto &st : stats) {
+        total.merge(st->total);
+        connect_ns.merge(st->connect_ns);
+        requests += st->requests;
+        connects += st->connects;
+        errors += st->errors;
+    }
+    double sec = (now_ns() - start) / 1e9;
+    printf("mode=%s conns=%d size=%zu: %llu requests, %.0f req/s, "
+           "%llu errors\n", c.mode.c_str(), c.conns, c.size,
+           (unsigned long long) requests, requests / sec,
+           (unsigned long long) errors);
+    total.print(stdout, "total latency(us)");
+    if (connects) {
+        printf("%.0f connects/s\n", connects / sec);
+        connect_ns.print(stdout, "connect latency(us)");
+    }
+    g_server_stop = true;
+    if (server.joinable())
+        server.join();
+    return 0;
+}
@@ -23,7 +23,7 @@ int main() {
         for (int i = 0; i < 20; i++) {
             puts("sending");
             tryForMaxInterval(6, 1, [&]() {
-                s.fsend("i am client hoho! %d\n", i);
+                s.send_fmt("i am client hoho! {}\n", i);
                 puts(s.recv());
             });
             sleep(4);
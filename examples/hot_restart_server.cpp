@@ -0,0 +1,101 @@
+/*
+ * hot_restart_server.cpp
+ *
+ *  echo server restartable without downtime: start a second instance
+ *  and it takes the listening socket over from the running one, which
+ *  then stops accepting and drains its connections for up to 10s.
+ */
+
+#include "../src/tmpl_socket.h"
+#include "../src/handoff.h"
+#include <atomic>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <memory>
+#include <poll.h>
+using bylSocket::Domain;
+using bylSocket::Type;
+using bylSocket::Options;
+using bylSocket::Status;
+using bylSocket::Drainer;
+using bylSocket::HandoffFds;
+using bylSocket::Tmpl::BufferedSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+using namespace std;
+
+static const char *HANDOFF_NAME = "bylsocket_hot_restart";
+static std::atomic<bool> g_handed_off(false);
+static Drainer g_drainer;
+
+void worker(Socket<Domain::IP4, Type::STREAM> client,
+            std::shared_ptr<Drainer::Guard> /* held while serving */) {
+    auto bc = BufferedSocket<Domain::IP4, Type::STREAM>(client);
+    bc.set_opt(Options::RCVTIMEO, 2);
+    try {
+        while (true)
+            bc.send(bc.recv());
+    } catch (std::exception &e) {
+        err_report(e.what());
+    }
+}
+
+static Socket<Domain::IP4, Type::STREAM> open_listener() {
+    HandoffFds fds;
+    if (bylSocket::handoff_take(HANDOFF_NAME, fds)) {
+        cout << "took over from the running instance" << endl;
+        return Socket<Domain::IP4, Type::STREAM>(fds.listeners.at(0),
+                                                 Status::LISTENING);
+    }
+    return ListenedSocket<Domain::IP4>();
+}
+
+int main() {
+    auto listener = open_listener();
+    /**
+     * the successor may accept what poll reported first, non-blocking
+     * so the loser gets EAGAIN instead of hanging in accept
+     */
+    int flags = fcntl(listener.fd(), F_GETFL);
+    if (flags == -1
+        || fcntl(listener.fd(), F_SETFL, flags | O_NONBLOCK) == -1)
+        err_report_and_throw("fcntl");
+
+    std::thread offer([&]() {
+        try {
+            g_handed_off = bylSocket::handoff_offer(HANDOFF_NAME,
+                                                    {listener.fd()});
+        } catch (std::exception &e) {
+            err_report(e.what());
+        }
+    });
+
+    /**
+     * poll instead of a timeout on the listener, socket options are
+     * shared with the successor
+     */
+    while (!g_handed_off) {
+        struct pollfd p = {listener.fd(), POLLIN, 0};
+        if (poll(&p, 1, 200) <= 0 || g_handed_off)
+            continue;
+        int fd = accept4(listener.fd(), nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            // EAGAIN: the successor got it
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                err_report("accept4");
+            continue;
+        }
+        Socket<Domain::IP4, Type::STREAM> client(fd, Status::CONNECTED);
+        // admitted before the thread runs, drain() can't miss it
+        auto guard = std::make_shared<Drainer::Guard>(g_drainer);
+        if (!guard->admitted())
+            continue;
+        std::thread(worker, client, guard).detach();
+    }
+    offer.join();
+    cout << "handed off, draining " << g_drainer.active() << endl;
+    bool drained = g_drainer.drain(std::chrono::seconds(10));
+    cout << (drained ? "drained" : "drain deadline passed") << endl;
+    return 0;
+}
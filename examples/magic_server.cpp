@@ -27,8 +27,9 @@ void worker(Socket<Domain::IP4, Type::STREAM> client) {
         do {
             tryForMax(5, [&]() {
                 bc.recv();
-                bc.fsend("I am worker %ld from server\n",
-                         std::this_thread::get_id());
+                bc.send_fmt("I am worker {} from server\n",
+                            std::hash<std::thread::id>()(
+                                    std::this_thread::get_id()));
             });
         } while (true);
     } catch (std::exception &e) {
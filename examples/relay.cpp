@@ -0,0 +1,51 @@
+/*
+ * relay.cpp
+ *
+ *  sidecar forwarding local unix domain clients to an ip4 backend,
+ *  one thread for all connections.
+ *
+ *  usage: relay <unix name> <backend ip> <backend port>
+ */
+
+#include "../src/tmpl_socket.h"
+#include "../src/relay.h"
+#include <iostream>
+using bylSocket::Domain;
+using bylSocket::Type;
+using bylSocket::EventLoop;
+using bylSocket::BufferPool;
+using bylSocket::Relay;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+using namespace std;
+
+int main(int argc, char *argv[]) {
+    if (argc != 4) {
+        cerr << "usage: " << argv[0] << " <unix name> <ip> <port>" << endl;
+        return 1;
+    }
+    try {
+        ListenedSocket<Domain::UNIX> front(argv[1]);
+        EventLoop loop;
+        BufferPool pool;
+        Relay relay(loop, pool);
+        loop.add(front.fd(), EPOLLIN, [&](uint32_t) {
+            auto client = front.accept();
+            Socket<Domain::IP4, Type::STREAM> backend;
+            try {
+                backend.connect(argv[2], argv[3]);
+            } catch (std::exception &e) {
+                err_report(e.what());
+                return;
+            }
+            relay.add(client.fd(), backend.fd(), [](const Relay::Stats &s) {
+                printf("closed after %.3fs, up %.0f B/s down %.0f B/s\n",
+                       s.seconds, s.throughput(0), s.throughput(1));
+            });
+        });
+        loop.run();
+    } catch (std::exception &e) {
+        cout << e.what() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+//
+// Created on 10/19/26.
+//
+#include "admission.h"
+#include <fcntl.h>
+#include <netinet/tcp.h>
+
+namespace bylSocket {
+
+AdmissionControl::AdmissionControl(EventLoop &loop, int listen_fd,
+                                   AcceptCallback on_accept,
+                                   const AdmissionOptions &o)
+        : m_loop(loop), m_fd(listen_fd), m_on_accept(std::move(on_accept)),
+          m_opt(o), m_connections(0), m_in_flight(0), m_paused(false),
+          m_retry(0) {
+    assert_n_throw(listen_fd >= 0 && m_on_accept && o.batch > 0
+                   && o.fd_retry_ms > 0);
+    int flags = fcntl(m_fd, F_GETFL);
+    if (flags == -1 || fcntl(m_fd, F_SETFL, flags | O_NONBLOCK) == -1)
+        err_report_and_throw("fcntl");
+    m_loop.add(m_fd, EPOLLIN, [this](uint32_t) { on_readable(); });
+    // the retry timer is added when there are no fds left
+    m_loop.prepare_timers();
+    if (m_opt.shed == AdmissionOptions::Shed::PAUSE && overloaded())
+        pause();
+}
+
+AdmissionControl::~AdmissionControl() {
+    if (m_retry)
+        m_loop.cancel_timer(m_retry);
+    m_loop.remove(m_fd);
+}
+
+void AdmissionControl::closed() {
+    assert_n_throw(m_connections > 0);
+    --m_connections;
+    update();
+}
+
+void AdmissionControl::work_end() {
+    assert_n_throw(m_in_flight > 0);
+    --m_in_flight;
+    update();
+}
+
+bool AdmissionControl::overloaded() const {
+    return m_connections >= m_opt.max_connections
+           || m_in_flight >= m_opt.max_in_flight
+           || (m_opt.budget && m_opt.budget->used() > m_opt.memory_high);
+}
+
+void AdmissionControl::update() {
+    if (m_paused && !overloaded()) {
+        m_loop.modify(m_fd, EPOLLIN);
+        m_paused = false;
+    }
+    if (!m_paused && m_retry) {
+        m_loop.cancel_timer(m_retry);
+        m_retry = 0;
+    }
+}
+
+void AdmissionControl::pause() {
+    m_loop.modify(m_fd, 0);
+    m_paused = true;
+    ++m_stats.pauses;
+}
+
+void AdmissionControl::out_of_fds() {
+    if (!m_paused) {
+        m_loop.modify(m_fd, 0);
+        m_paused = true;
+        ++m_stats.fd_pauses;
+    }
+    // the fds may be freed by someone not reporting to us
+    if (!m_retry)
+        m_retry = m_loop.add_timer((uint64_t) m_opt.fd_retry_ms * 1000000,
+                                   [this]() {
+                                       m_retry = 0;
+                                       update();
+                                   });
+}
+
+int AdmissionControl::pending() const {
+    struct tcp_info ti;
+    socklen_t len = sizeof ti;
+    if (getsockopt(m_fd, IPPROTO_TCP, TCP_INFO, &ti, &len) == -1)
+        return -1;
+    // of a listening socket: the accept queue length
+    return (int) ti.tcpi_unacked;
+}
+
+void AdmissionControl::reset(int fd) {
+    struct linger l = {1, 0};
+    if (setsockopt(fd, SOL_SOCKET, SO_LINGER, &l, sizeof l) == -1)
+        err_report("setsockopt SO_LINGER");
+    if (close(fd) == -1)
+        err_report("close");
+}
+
+void AdmissionControl::on_readable() {
+    for (int i = 0; i < m_opt.batch; ++i) {
+        bool over = overloaded();
+        if (over && m_opt.shed == AdmissionOptions::Shed::PAUSE) {
+            pause();
+            return;
+        }
+        int fd = accept4(m_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            // concern that one connection only
+            if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO)
+                continue;
+            if (errno == EMFILE || errno == ENFILE) {
+                err_report("accept4");
+                out_of_fds();
+                return;
+            }
+            err_report_and_throw("accept4");
+        }
+        if (over) {
+            reset(fd);
+            ++m_stats.shed;
+            continue;
+        }
+        ++m_connections;
+        ++m_stats.accepted;
+        m_on_accept(fd);
+    }
+}
+
+}
@@ -0,0 +1,114 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_ADMISSION_H
+#define BYLSOCKET_ADMISSION_H
+#include "common.h"
+#include "event_loop.h"
+#include "outbound_queue.h"
+
+namespace bylSocket {
+
+struct AdmissionOptions {
+    enum class Shed {
+        //! stop accepting, new connections wait in the listen backlog
+        PAUSE,
+        //! accept and reset (SO_LINGER 0) right away
+        RESET
+    };
+    //! admitted connections open at once
+    size_t max_connections = SIZE_MAX;
+    //! requests being worked on, see AdmissionControl::work_begin()
+    size_t max_in_flight = SIZE_MAX;
+    //! overloaded while more than memory_high bytes of budget are used
+    const MemoryBudget *budget = nullptr;
+    size_t memory_high = SIZE_MAX;
+    Shed shed = Shed::PAUSE;
+    //! accepts per wakeup, so a connect storm can't starve the loop
+    int batch = 64;
+    //! out of fds, retry accepting after this long at the latest
+    int fd_retry_ms = 100;
+};
+
+/**
+ * admission control for a listening socket driven by an EventLoop.
+ *
+ * connections are handed to on_accept while the server is not
+ * overloaded, i.e. below max_connections, max_in_flight and memory_high.
+ * beyond that they are shed: left in the kernel's backlog, which drops
+ * the excess handshakes once full (Shed::PAUSE), or accepted and reset
+ * at once, which costs no more than the accept (Shed::RESET).
+ *
+ * the owner reports closed() connections and work_begin()/work_end(),
+ * and calls update() when memory got freed, e.g. from
+ * OutboundQueue::on_low, to resume accepting. out of fds (EMFILE,
+ * ENFILE) accepting pauses too, and is retried on the next of those
+ * calls or after fd_retry_ms, whichever comes first.
+ *
+ * N.B. the listening fd is not owned, it is made non-blocking.
+ */
+class AdmissionControl {
+public:
+    //! takes the accepted fd (SOCK_CLOEXEC) over
+    typedef std::function<void(int fd)> AcceptCallback;
+
+    struct Stats {
+        uint64_t accepted = 0;
+        //! reset by Shed::RESET, those left in the backlog aren't counted
+        uint64_t shed = 0;
+        //! times accepting got paused by overload
+        uint64_t pauses = 0;
+        //! times accepting got paused running out of fds
+        uint64_t fd_pauses = 0;
+    };
+
+    AdmissionControl(EventLoop &loop, int listen_fd, AcceptCallback on_accept,
+                     const AdmissionOptions &o = AdmissionOptions());
+    template<class S>
+    AdmissionControl(EventLoop &loop, S &listener, AcceptCallback on_accept,
+                     const AdmissionOptions &o = AdmissionOptions())
+            : AdmissionControl(loop, listener.fd(), std::move(on_accept), o) {}
+    ~AdmissionControl();
+    AdmissionControl(const AdmissionControl &) = delete;
+    AdmissionControl &operator=(const AdmissionControl &) = delete;
+
+    //! an admitted connection got closed
+    void closed();
+    void work_begin() { ++m_in_flight; }
+    void work_end();
+    //! resume accepting if no longer overloaded
+    void update();
+
+    bool overloaded() const;
+    bool paused() const { return m_paused; }
+    size_t connections() const { return m_connections; }
+    size_t in_flight() const { return m_in_flight; }
+    /**
+     * connections waiting in the listen backlog, tcp only
+     * @return -1 if unknown
+     */
+    int pending() const;
+    const Stats &stats() const { return m_stats; }
+
+    //! close fd with SO_LINGER 0, i.e. send a RST and free it right away
+    static void reset(int fd);
+private:
+    void on_readable();
+    void pause();
+    //! accept4 failed with EMFILE or ENFILE
+    void out_of_fds();
+
+    EventLoop &m_loop;
+    int m_fd;
+    AcceptCallback m_on_accept;
+    AdmissionOptions m_opt;
+    size_t m_connections;
+    size_t m_in_flight;
+    bool m_paused;
+    EventLoop::TimerId m_retry;
+    Stats m_stats;
+};
+
+}
+#endif //BYLSOCKET_ADMISSION_H
@@ -0,0 +1,143 @@
+//
+// Created on 10/19/26.
+//
+#include "broadcaster.h"
+#include <vector>
+
+namespace bylSocket {
+
+struct Broadcaster::Subscriber {
+    Subscriber(int fd, GoneCallback cb, MemoryBudget *budget)
+            : queue(fd, SIZE_MAX, SIZE_MAX, budget), on_gone(std::move(cb)),
+              writing(false) {}
+    OutboundQueue queue;
+    GoneCallback on_gone;
+    //! EPOLLOUT registered
+    bool writing;
+};
+
+/**
+ * owner of a published chunk as the subscribers share it, gives the
+ * message's bytes back to the budget once the last queue let go
+ */
+struct Broadcaster::Holder {
+    Chunk chunk;
+    MemoryBudget *budget;
+    size_t *held;
+    ~Holder() {
+        budget->release(chunk->size());
+        *held -= chunk->size();
+    }
+};
+
+Broadcaster::Broadcaster(EventLoop &loop, SlowPolicy policy, size_t max_backlog,
+                         MemoryBudget *budget)
+        : m_loop(loop), m_policy(policy), m_max_backlog(max_backlog),
+          m_budget(budget), m_held(0) {
+    assert_n_throw(budget);
+}
+
+Broadcaster::~Broadcaster() {
+    for (auto &s : m_subs)
+        m_loop.remove(s.first);
+}
+
+void Broadcaster::subscribe(int fd, GoneCallback on_gone) {
+    assert_n_throw(fd >= 0 && !m_subs.count(fd));
+    m_subs[fd].reset(new Subscriber(fd, std::move(on_gone), &m_queue_budget));
+    // no interest until something is queued, errors and hangups still
+    // get reported
+    m_loop.add(fd, 0, [this, fd](uint32_t events) { on_event(fd, events); });
+}
+
+void Broadcaster::unsubscribe(int fd) {
+    auto it = m_subs.find(fd);
+    if (it == m_subs.end())
+        return;
+    m_loop.remove(fd);
+    m_subs.erase(it);
+}
+
+size_t Broadcaster::backlog(int fd) const {
+    auto it = m_subs.find(fd);
+    return it == m_subs.end() ? 0 : it->second->queue.queued();
+}
+
+size_t Broadcaster::publish(const Chunk &c) {
+    ++m_stats.published;
+    if (!m_budget->try_acquire(c->size())) {
+        ++m_stats.rejected;
+        return 0;
+    }
+    m_held += c->size();
+    // shares c's bytes, owns the holder giving them back to the budget
+    std::shared_ptr<Holder> holder(new Holder{c, m_budget, &m_held});
+    Chunk shared(holder, c.get());
+    holder.reset();
+
+    size_t delivered = 0;
+    std::vector<int> gone;
+    for (auto &it : m_subs) {
+        Subscriber &s = *it.second;
+        // a message larger than max_backlog still goes to the idle
+        if (!s.queue.empty() && s.queue.queued() + c->size() > m_max_backlog) {
+            if (m_policy == SlowPolicy::DROP) {
+                ++m_stats.dropped;
+                continue;
+            }
+            gone.push_back(it.first);
+            continue;
+        }
+        try {
+            s.queue.send(shared);
+        } catch (std::logic_error &) {
+            gone.push_back(it.first);
+            continue;
+        }
+        ++delivered;
+        update_interest(it.first, s);
+    }
+    for (int fd : gone)
+        drop(fd);
+    m_stats.delivered += delivered;
+    return delivered;
+}
+
+void Broadcaster::on_event(int fd, uint32_t events) {
+    auto it = m_subs.find(fd);
+    if (it == m_subs.end())
+        return;
+    Subscriber &s = *it->second;
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        drop(fd);
+        return;
+    }
+    try {
+        s.queue.flush();
+    } catch (std::logic_error &) {
+        drop(fd);
+        return;
+    }
+    update_interest(fd, s);
+}
+
+void Broadcaster::drop(int fd) {
+    auto it = m_subs.find(fd);
+    if (it == m_subs.end())
+        return;
+    GoneCallback cb = std::move(it->second->on_gone);
+    unsubscribe(fd);
+    ++m_stats.disconnected;
+    if (cb)
+        cb(fd);
+}
+
+void Broadcaster::update_interest(int fd, Subscriber &s) {
+    bool want = !s.queue.empty();
+    if (want != s.writing) {
+        m_loop.modify(fd, want ? (uint32_t) EPOLLOUT : 0u);
+        s.writing = want;
+    }
+}
+
+}
@@ -0,0 +1,106 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_BROADCASTER_H
+#define BYLSOCKET_BROADCASTER_H
+#include "common.h"
+#include "event_loop.h"
+#include "format.h"
+#include "outbound_queue.h"
+#include <unordered_map>
+
+namespace bylSocket {
+
+/**
+ * fans one message out to many subscribed connections.
+ *
+ * a message is serialized once into an immutable OutboundQueue::Chunk
+ * and that very chunk is queued on every subscriber, each of which
+ * writes its backlog with batched sendmsg() when the loop reports it
+ * writable. the memory budget is charged once per message while any
+ * subscriber still holds it, not once per subscriber.
+ *
+ * a subscriber with a backlog the message would grow beyond max_backlog
+ * is slow: it misses the message (SlowPolicy::DROP) or gets unsubscribed
+ * (SlowPolicy::DISCONNECT). subscribers are also unsubscribed on socket
+ * errors and hangups, on_gone is told so in any case.
+ *
+ * N.B. fds are not owned, and only watched for writing: they must not be
+ * added to the loop by anyone else.
+ */
+class Broadcaster {
+public:
+    enum class SlowPolicy {
+        DROP,
+        DISCONNECT
+    };
+    typedef OutboundQueue::Chunk Chunk;
+    //! called with the fd of a subscriber that got unsubscribed by the broadcaster
+    typedef std::function<void(int fd)> GoneCallback;
+
+    struct Stats {
+        uint64_t published = 0;
+        //! messages written or queued, summed over subscribers
+        uint64_t delivered = 0;
+        uint64_t dropped = 0;
+        uint64_t disconnected = 0;
+        //! published but rejected by the memory budget
+        uint64_t rejected = 0;
+    };
+
+    explicit Broadcaster(EventLoop &loop,
+                         SlowPolicy policy = SlowPolicy::DROP,
+                         size_t max_backlog = 1 << 20,
+                         MemoryBudget *budget = &MemoryBudget::global());
+    ~Broadcaster();
+    Broadcaster(const Broadcaster &) = delete;
+    Broadcaster &operator=(const Broadcaster &) = delete;
+
+    void subscribe(int fd, GoneCallback on_gone = GoneCallback());
+    //! drops what's still queued for fd
+    void unsubscribe(int fd);
+    size_t subscribers() const { return m_subs.size(); }
+
+    /**
+     * queue c on every subscriber
+     * @return subscribers it was delivered to, 0 if the budget rejected it
+     */
+    size_t publish(const Chunk &c);
+    size_t publish(const void *data, size_t len) {
+        return publish(std::make_shared<const std::string>((const char *) data, len));
+    }
+    //! format once by bylSocket::format_to, then publish
+    template<typename ... Args>
+    size_t publish_fmt(const char *format, const Args &... args) {
+        std::string s;
+        format_to(s, format, args...);
+        return publish(std::make_shared<const std::string>(std::move(s)));
+    }
+
+    //! bytes of the distinct messages still queued somewhere
+    size_t held_bytes() const { return m_held; }
+    //! bytes queued for fd
+    size_t backlog(int fd) const;
+    const Stats &stats() const { return m_stats; }
+private:
+    struct Subscriber;
+    struct Holder;
+
+    void on_event(int fd, uint32_t events);
+    void drop(int fd);
+    void update_interest(int fd, Subscriber &s);
+
+    EventLoop &m_loop;
+    SlowPolicy m_policy;
+    size_t m_max_backlog;
+    MemoryBudget *m_budget;
+    //! declared before m_subs, the queues account to it until destroyed
+    size_t m_held;
+    MemoryBudget m_queue_budget;
+    std::unordered_map<int, std::unique_ptr<Subscriber>> m_subs;
+    Stats m_stats;
+};
+
+}
+#endif //BYLSOCKET_BROADCASTER_H
@@ -0,0 +1,28 @@
+//
+// Created on 10/19/26.
+//
+#include "buffer_pool.h"
+
+namespace bylSocket {
+
+char *BufferPool::get() {
+    if (m_free.empty())
+        return new char[m_size];
+    char *b = m_free.back();
+    m_free.pop_back();
+    return b;
+}
+
+void BufferPool::put(char *buf) {
+    if (m_free.size() < m_max_free)
+        m_free.push_back(buf);
+    else
+        delete[] buf;
+}
+
+BufferPool::~BufferPool() {
+    for (char *b : m_free)
+        delete[] b;
+}
+
+}
@@ -0,0 +1,31 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_BUFFER_POOL_H
+#define BYLSOCKET_BUFFER_POOL_H
+#include "common.h"
+#include <vector>
+
+namespace bylSocket {
+
+//! free list of fixed size buffers
+class BufferPool {
+public:
+    explicit BufferPool(size_t buf_size = 64 << 10, size_t max_free = 1024)
+            : m_size(buf_size), m_max_free(max_free) {}
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    char *get();
+    void put(char *buf);
+    size_t buf_size() const { return m_size; }
+    ~BufferPool();
+private:
+    size_t m_size;
+    size_t m_max_free;
+    std::vector<char *> m_free;
+};
+
+}
+#endif //BYLSOCKET_BUFFER_POOL_H
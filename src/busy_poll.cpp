@@ -0,0 +1,85 @@
+//
+// Created on 10/19/26.
+//
+#include "busy_poll.h"
+#include "metrics.h"
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+
+namespace bylSocket {
+
+//! the adaptive budget never drops below this
+static const uint64_t MIN_SPIN_NS = 1000;
+
+BusyPoller::BusyPoller(uint64_t max_spin_ns, bool adaptive)
+        : m_max_spin_ns(max_spin_ns), m_spin_ns(max_spin_ns),
+          m_adaptive(adaptive), m_stats{0, 0, 0} {}
+
+ssize_t BusyPoller::recv(int fd, void *buf, size_t len, int timeout_ms) {
+    uint64_t start = now_ns();
+    uint64_t end = timeout_ms < 0 ? UINT64_MAX
+                                  : start + (uint64_t) timeout_ms * 1000000;
+    uint64_t spin_end = std::min(start + m_spin_ns, end);
+    for (unsigned i = 0;; ++i) {
+        ssize_t n = ::recv(fd, buf, len, MSG_DONTWAIT);
+        if (n >= 0) {
+            ++m_stats.spin_hits;
+            if (m_adaptive && i)
+                m_spin_ns = std::min(m_spin_ns * 2, m_max_spin_ns);
+            return n;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return n;
+        ++m_stats.empty_polls;
+        // reading the clock every poll would dominate a short spin
+        if ((i & 15) == 15 && now_ns() >= spin_end)
+            break;
+        cpu_relax();
+    }
+
+    ++m_stats.parks;
+    if (m_adaptive)
+        m_spin_ns = std::max(m_spin_ns / 2, std::min(MIN_SPIN_NS,
+                                                     m_max_spin_ns));
+    // one deadline for the spin and every poll, wakeups in vain included
+    for (;;) {
+        int wait_ms = -1;
+        if (end != UINT64_MAX) {
+            uint64_t now = now_ns();
+            if (now >= end) {
+                errno = EAGAIN;
+                return -1;
+            }
+            wait_ms = (int) ((end - now + 999999) / 1000000);
+        }
+        struct pollfd p = {fd, POLLIN, 0};
+        int r = poll(&p, 1, wait_ms);
+        if (r == -1 && errno == EINTR)
+            continue;
+        if (r == -1)
+            return -1;
+        if (r == 0)
+            continue;
+        ssize_t n = ::recv(fd, buf, len, MSG_DONTWAIT);
+        if (n >= 0 || (errno != EAGAIN && errno != EINTR))
+            return n;
+    }
+}
+
+void pin_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int e = pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+    if (e) {
+        errno = e;
+        err_report_and_throw("pthread_setaffinity_np");
+    }
+}
+
+int current_cpu() {
+    return sched_getcpu();
+}
+
+}
@@ -0,0 +1,57 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_BUSY_POLL_H
+#define BYLSOCKET_BUSY_POLL_H
+#include "common.h"
+
+namespace bylSocket {
+
+/**
+ * spin-then-park receiver for latency sensitive consumers owning a
+ * dedicated core.
+ *
+ * recv() polls the socket with MSG_DONTWAIT for up to the spin budget
+ * and only then parks in poll(). in adaptive mode the budget doubles
+ * (up to max) whenever data turned up while spinning and halves whenever
+ * the spin was in vain, so an idle feed stops burning the core.
+ *
+ * combine with Options::BUSY_POLL on the socket to also let the kernel
+ * busy poll the device queue, and with pin_thread.
+ */
+class BusyPoller {
+public:
+    struct Stats {
+        //! recv()s served while spinning
+        uint64_t spin_hits;
+        //! recv()s that had to park
+        uint64_t parks;
+        //! MSG_DONTWAIT attempts in vain
+        uint64_t empty_polls;
+    };
+
+    explicit BusyPoller(uint64_t max_spin_ns = 50000, bool adaptive = true);
+
+    /**
+     * @param timeout_ms in all, spinning included, -1 forever
+     * @return bytes received, 0 at eof, -1 with errno EAGAIN on timeout
+     */
+    ssize_t recv(int fd, void *buf, size_t len, int timeout_ms = -1);
+
+    const Stats &stats() const { return m_stats; }
+    uint64_t spin_budget_ns() const { return m_spin_ns; }
+private:
+    uint64_t m_max_spin_ns;
+    uint64_t m_spin_ns;
+    bool m_adaptive;
+    Stats m_stats;
+};
+
+//! bind the calling thread to one cpu
+void pin_thread(int cpu);
+//! cpu the calling thread runs on
+int current_cpu();
+
+}
+#endif //BYLSOCKET_BUSY_POLL_H
@@ -7,6 +7,8 @@
 //============================================================================
 
 #include "byl_socket.hpp"
+#include "fd_passing.h"
+#include "transport.h"
 
 static void deleter(int *pf) {
     assert(pf && "deleter");
@@ -91,8 +93,16 @@ void bylSocket::Socket::set_opt(Options o, time_t sec, long int nsec) {
      *      otherwise throwing invalid argument error
      */
     int optval = true;
+    if (o == Options::BUSY_POLL || o == Options::TIMESTAMPING)
+        optval = (int) sec;
     void *p = &optval;
     socklen_t len = sizeof optval;
+    // 64 bit, rates above 4GB/s don't fit an int
+    uint64_t rate = (uint64_t) sec;
+    if (o == Options::MAX_PACING_RATE) {
+        p = &rate;
+        len = sizeof rate;
+    }
     struct timeval t = {sec, nsec};
     if (o == Options::RCVTIMEO || o == Options::SNDTIMEO) {
         p = &t;
@@ -138,15 +148,19 @@ void bylSocket::Socket::connect(const char *remote, const char *port) {
 }
 
 void bylSocket::Socket::listen(int backlog) {
-    assert_n_throw(m_status == Status::BINDED && m_type == Type::STREAM);
+    assert_n_throw(m_status == Status::BINDED
+                   && (m_type == Type::STREAM || m_type == Type::SEQPACKET));
 
+    if (backlog == BACKLOG_SOMAXCONN)
+        backlog = somaxconn();
     if (::listen(*m_pfd, backlog) == -1)
         err_report_and_throw("listen");
     m_status = Status::LISTENING;
 }
 
 bylSocket::Socket bylSocket::Socket::accept() {
-    assert_n_throw(m_status == Status::LISTENING && m_type == Type::STREAM);
+    assert_n_throw(m_status == Status::LISTENING
+                   && (m_type == Type::STREAM || m_type == Type::SEQPACKET));
 
     int fd = ::accept(*m_pfd, NULL, NULL);
     if (fd == -1)
@@ -154,6 +168,17 @@ bylSocket::Socket bylSocket::Socket::accept() {
     return Socket(fd, m_domain, m_type, Status::CONNECTED);
 }
 
+void bylSocket::Socket::send_fds(const int *fds, int nfds, const char *msg) {
+    assert_n_throw(m_domain == Domain::UNIX && m_status == Status::CONNECTED);
+    bylSocket::send_fds(*m_pfd, fds, nfds, msg, strlen(msg) + 1);
+}
+
+int bylSocket::Socket::recv_fds(int *fds, int max_fds, char *msg, int msg_len) {
+    assert_n_throw(m_domain == Domain::UNIX && m_status == Status::CONNECTED);
+    assert_n_throw(msg_len >= 0);
+    return bylSocket::recv_fds(*m_pfd, fds, max_fds, msg, (size_t) msg_len);
+}
+
 void bylSocket::BufferedSocket::fsend(const char *format, ...) {
     va_list argptr;
     va_start(argptr, format);
@@ -187,6 +212,13 @@ void bylSocket::BufferedSocket::send(const char *str) {
         err_report_and_throw("send");
     }
 }
+void bylSocket::BufferedSocket::send_wbuf() {
+    write_full(*m_pfd, m_wbuf.data(), m_wbuf.size());
+    // don't let one huge reply pin its buffer for the connection's life
+    if (m_wbuf.capacity() > WBUF_KEEP)
+        std::string().swap(m_wbuf);
+}
+
 const char *bylSocket::BufferedSocket::recv(int n) {
     assert_n_throw(m_status == bylSocket::Status::BINDED
                    || m_status == bylSocket::Status::CONNECTED);
@@ -203,20 +235,24 @@ const char *bylSocket::BufferedSocket::recv(int n) {
 }
 bylSocket::BufferedSocket::BufferedSocket(Domain d, Type t) : Socket(d, t) {}
 bylSocket::BufferedSocket::BufferedSocket(const Socket &o) : Socket(o) {}
-bylSocket::BufferedSocket::BufferedSocket(const bylSocket::BufferedSocket &o) : Socket(o) {}
+bylSocket::BufferedSocket::BufferedSocket(const bylSocket::BufferedSocket &o)
+        : Socket(o), m_fmt_nul(o.m_fmt_nul) {}
 
 bylSocket::BufferedSocket &bylSocket::
 BufferedSocket::operator=(const bylSocket::BufferedSocket &o) {
     Socket::operator=(o);
+    m_fmt_nul = o.m_fmt_nul;
     return *this;
 }
 
 bylSocket::BufferedSocket::
-BufferedSocket(bylSocket::BufferedSocket &&o) : Socket::Socket(std::move(o)) {}
+BufferedSocket(bylSocket::BufferedSocket &&o)
+        : Socket::Socket(std::move(o)), m_fmt_nul(o.m_fmt_nul) {}
 
 bylSocket::BufferedSocket &bylSocket::
 BufferedSocket::operator=(bylSocket::BufferedSocket &&o) {
     Socket::operator=(std::move(o));
+    m_fmt_nul = o.m_fmt_nul;
     return *this;
 }
 bylSocket::BufferedSocket::BufferedSocket(bylSocket::Socket &&o)
@@ -229,7 +265,9 @@ bylSocket::ListenedSocket::ListenedSocket(Domain d,
                                           const char *local,
                                           int backlog) : Socket(d, Type::STREAM) {
     this->set_opt(Options::REUSEADDR);
-    this->set_opt(Options::REUSEPORT);
+    // SO_REUSEPORT is not supported by unix domain sockets
+    if (d != Domain::UNIX)
+        this->set_opt(Options::REUSEPORT);
     this->bind(local, port);
     listen(backlog);
 }
@@ -9,6 +9,7 @@
 #define __BYLSOCKET_HPP__
 
 #include "common.h"
+#include "format.h"
 
 namespace bylSocket {
 
@@ -54,6 +55,7 @@ public:
     Socket(Domain d, Type t);
     void bind(const char *local, const char *port = "\0");
     void connect(const char *remote, const char *port = "\0");
+    //! @param backlog BACKLOG_SOMAXCONN for the kernel's maximum
     void listen(int backlog);
     Socket accept();
 
@@ -64,9 +66,32 @@ public:
 
     virtual ~Socket() {}
 
+    /**
+     * @param o
+     * @param sec seconds of RCVTIMEO/SNDTIMEO, or the value of a valued
+     *        option, e.g. usecs of BUSY_POLL
+     * @param nsec
+     */
     void set_opt(Options o, time_t sec = 0, long int nsec = 0);
-protected:
+
+    /**
+     * pass fds to the peer as SCM_RIGHTS ancillary data,
+     * only for Domain::UNIX. see bylSocket::send_fds
+     * @param msg payload carrying the fds, sent with its '\0'
+     */
+    void send_fds(const int *fds, int nfds, const char *msg = "");
+    /**
+     * receive fds passed by send_fds, only for Domain::UNIX.
+     * the received fds can be adopted by Socket(fd, d, t, Status::CONNECTED)
+     * @param msg buffer for the payload, must hold what the peer sent
+     * @return number of fds received
+     */
+    int recv_fds(int *fds, int max_fds, char *msg = nullptr, int msg_len = 0);
+
+    //! adopt an already opened fd, e.g. one received by recv_fds
     Socket(int fd, Domain d, Type t, Status ss);
+    int fd() const { return *m_pfd; }
+protected:
     std::shared_ptr<int> m_pfd;
     Domain               m_domain;
     Type                 m_type;
@@ -93,9 +118,29 @@ public:
     void send(const char *str);
     const char *recv(int n = BUFSZ - 1);
 
+    /**
+     * format by bylSocket::format_to into a growable buffer and send it,
+     * nothing gets truncated. the trailing '\0' fsend always adds is
+     * only sent if fmt_nul is enabled (default).
+     */
+    template<typename ... Args>
+    void send_fmt(const char *format, const Args &... args) {
+        m_wbuf.clear();
+        format_to(m_wbuf, format, args...);
+        if (m_fmt_nul)
+            m_wbuf.push_back('\0');
+        send_wbuf();
+    }
+    void set_fmt_nul(bool on) { m_fmt_nul = on; }
+
 protected:
+    void send_wbuf();
+
     static const int BUFSZ = 512;
+    static const size_t WBUF_KEEP = 64 << 10;
     char m_buff[BUFSZ];
+    std::string m_wbuf;
+    bool m_fmt_nul = true;
 };
 
 /**
@@ -106,10 +151,10 @@ public:
     explicit ListenedSocket(Domain d = Domain::IP4,
                             const char *port = "50000",
                             const char *local = "127.0.0.1",
-                            int backlog = 50);
+                            int backlog = BACKLOG_SOMAXCONN);
 
     //! Convenient constructor for Unix Domain Socket
-    explicit ListenedSocket(const char *local, int backlog = 50);
+    explicit ListenedSocket(const char *local, int backlog = BACKLOG_SOMAXCONN);
 };
 
 }// bylSocket
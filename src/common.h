@@ -11,10 +11,18 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/un.h>
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
+
 namespace bylSocket {
 
 enum class Domain { UNIX = AF_UNIX, IP4 = AF_INET, IP6 = AF_INET6 };
-enum class Type { STREAM = SOCK_STREAM, DGRAM = SOCK_DGRAM };
+enum class Type {
+    STREAM = SOCK_STREAM,
+    DGRAM = SOCK_DGRAM,
+    SEQPACKET = SOCK_SEQPACKET //!< reliable, connected, record preserving
+};
 enum class Status { UNINITIALIZED, FREE, BINDED, LISTENING, CONNECTED };
 enum class Options {
     DGRAM_BROADCAST = SO_BROADCAST,
@@ -22,9 +30,32 @@ enum class Options {
     REUSEPORT = SO_REUSEPORT,
     KEEPALIVE = SO_KEEPALIVE,
     RCVTIMEO = SO_RCVTIMEO,
-    SNDTIMEO = SO_SNDTIMEO
+    SNDTIMEO = SO_SNDTIMEO,
+    BUSY_POLL = SO_BUSY_POLL,              //!< valued: usecs to busy poll
+    PREFER_BUSY_POLL = SO_PREFER_BUSY_POLL,
+    TIMESTAMPNS = SO_TIMESTAMPNS,          //!< rx time as SCM_TIMESTAMPNS
+    TIMESTAMPING = SO_TIMESTAMPING,        //!< valued: SOF_TIMESTAMPING_*
+    MAX_PACING_RATE = SO_MAX_PACING_RATE   //!< valued: bytes per second, kernel paced
 };
 
+//! listen() backlog meaning the kernel's current maximum, see somaxconn()
+static const int BACKLOG_SOMAXCONN = -1;
+
+/**
+ * the largest listen() backlog the kernel grants, net.core.somaxconn as
+ * read at runtime, the compile time SOMAXCONN if that can't be read
+ */
+inline int somaxconn() {
+    int n = 0;
+    FILE *f = fopen("/proc/sys/net/core/somaxconn", "re");
+    if (f) {
+        if (fscanf(f, "%d", &n) != 1)
+            n = 0;
+        fclose(f);
+    }
+    return n > 0 ? n : SOMAXCONN;
+}
+
 }
 
 #endif //BYLSOCKET_COMMON_H
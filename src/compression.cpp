@@ -0,0 +1,262 @@
+//
+// Created on 10/19/26.
+//
+#include "compression.h"
+#ifdef BYLSOCKET_HAVE_LZ4
+#include <lz4.h>
+#endif
+#ifdef BYLSOCKET_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace bylSocket {
+
+static const char HELLO_MAGIC[4] = {'B', 'Y', 'L', 'Z'};
+static const uint8_t HELLO_VERSION = 1;
+
+//! FNV-1a, 0 for no dictionary
+static uint32_t dict_hash(const std::string &dict) {
+    if (dict.empty())
+        return 0;
+    uint32_t h = 2166136261u;
+    for (unsigned char c : dict)
+        h = (h ^ c) * 16777619u;
+    return h ? h : 1;
+}
+
+struct CompressedTransport::Contexts {
+#ifdef BYLSOCKET_HAVE_LZ4
+    LZ4_stream_t *lz4 = nullptr;
+    //! dictionary loaded once, copied into lz4 for every frame
+    LZ4_stream_t *lz4_dict = nullptr;
+#endif
+#ifdef BYLSOCKET_HAVE_ZSTD
+    ZSTD_CCtx *cctx = nullptr;
+    ZSTD_DCtx *dctx = nullptr;
+    ZSTD_CDict *cdict = nullptr;
+    ZSTD_DDict *ddict = nullptr;
+#endif
+    ~Contexts() {
+#ifdef BYLSOCKET_HAVE_LZ4
+        LZ4_freeStream(lz4);
+        LZ4_freeStream(lz4_dict);
+#endif
+#ifdef BYLSOCKET_HAVE_ZSTD
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+#endif
+    }
+};
+
+unsigned CompressedTransport::available() {
+    unsigned m = codec_bit(Codec::NONE);
+#ifdef BYLSOCKET_HAVE_LZ4
+    m |= codec_bit(Codec::LZ4);
+#endif
+#ifdef BYLSOCKET_HAVE_ZSTD
+    m |= codec_bit(Codec::ZSTD);
+#endif
+    return m;
+}
+
+CompressedTransport::CompressedTransport(int sock,
+                                         const CompressionOptions &opt)
+        : SocketTransport(sock), m_codec(Codec::NONE), m_use_dict(false),
+          m_threshold(opt.threshold), m_level(opt.level), m_ctx(new Contexts),
+          m_raw_bytes(0), m_wire_bytes(0) {
+    try {
+        handshake(opt);
+    } catch (...) {
+        delete m_ctx;
+        throw;
+    }
+}
+
+CompressedTransport::~CompressedTransport() {
+    delete m_ctx;
+}
+
+void CompressedTransport::handshake(const CompressionOptions &opt) {
+    unsigned mine = (opt.codecs | codec_bit(Codec::NONE)) & available();
+    uint32_t hash = dict_hash(opt.dictionary);
+    // magic, version, codec mask, dictionary hash
+    char hello[10];
+    memcpy(hello, HELLO_MAGIC, 4);
+    hello[4] = (char) HELLO_VERSION;
+    hello[5] = (char) mine;
+    uint32_t h = htonl(hash);
+    memcpy(hello + 6, &h, 4);
+    SocketTransport::send_frame(hello, sizeof hello);
+
+    char peer[sizeof hello];
+    if (SocketTransport::recv_frame(peer, sizeof peer) != sizeof peer ||
+        memcmp(peer, HELLO_MAGIC, 4) != 0 || peer[4] != (char) HELLO_VERSION) {
+        errno = EPROTO;
+        err_report_and_throw("compression handshake");
+    }
+    unsigned common = mine & (uint8_t) peer[5];
+    memcpy(&h, peer + 6, 4);
+    if (common & codec_bit(Codec::ZSTD))
+        m_codec = Codec::ZSTD;
+    else if (common & codec_bit(Codec::LZ4))
+        m_codec = Codec::LZ4;
+    m_use_dict = m_codec != Codec::NONE && hash != 0 && ntohl(h) == hash;
+    if (m_use_dict)
+        m_dict = opt.dictionary;
+
+#ifdef BYLSOCKET_HAVE_LZ4
+    if (m_codec == Codec::LZ4) {
+        m_ctx->lz4 = LZ4_createStream();
+        assert_n_throw(m_ctx->lz4);
+        if (m_use_dict) {
+            m_ctx->lz4_dict = LZ4_createStream();
+            assert_n_throw(m_ctx->lz4_dict);
+            LZ4_loadDict(m_ctx->lz4_dict, m_dict.data(), (int) m_dict.size());
+        }
+    }
+#endif
+#ifdef BYLSOCKET_HAVE_ZSTD
+    if (m_codec == Codec::ZSTD) {
+        m_ctx->cctx = ZSTD_createCCtx();
+        m_ctx->dctx = ZSTD_createDCtx();
+        assert_n_throw(m_ctx->cctx && m_ctx->dctx);
+        if (m_use_dict) {
+            m_ctx->cdict = ZSTD_createCDict(m_dict.data(), m_dict.size(),
+                                            m_level);
+            m_ctx->ddict = ZSTD_createDDict(m_dict.data(), m_dict.size());
+            assert_n_throw(m_ctx->cdict && m_ctx->ddict);
+        }
+    }
+#endif
+}
+
+/**
+ * compress into m_tx
+ * @return compressed size, 0 if it didn't shrink
+ */
+size_t CompressedTransport::compress(const void *data, size_t len) {
+    size_t n = 0;
+#ifdef BYLSOCKET_HAVE_LZ4
+    if (m_codec == Codec::LZ4) {
+        m_tx.resize(LZ4_compressBound((int) len));
+        if (m_use_dict)
+            memcpy(m_ctx->lz4, m_ctx->lz4_dict, sizeof(LZ4_stream_t));
+        else
+            LZ4_resetStream_fast(m_ctx->lz4);
+        int r = LZ4_compress_fast_continue(m_ctx->lz4, (const char *) data,
+                                           m_tx.data(), (int) len,
+                                           (int) m_tx.size(),
+                                           m_level > 0 ? m_level : 1);
+        n = r > 0 ? (size_t) r : 0;
+    }
+#endif
+#ifdef BYLSOCKET_HAVE_ZSTD
+    if (m_codec == Codec::ZSTD) {
+        m_tx.resize(ZSTD_compressBound(len));
+        size_t r = m_use_dict
+                   ? ZSTD_compress_usingCDict(m_ctx->cctx, m_tx.data(),
+                                              m_tx.size(), data, len,
+                                              m_ctx->cdict)
+                   : ZSTD_compressCCtx(m_ctx->cctx, m_tx.data(), m_tx.size(),
+                                       data, len, m_level);
+        n = ZSTD_isError(r) ? 0 : r;
+    }
+#endif
+    (void) data;
+    return n < len ? n : 0;
+}
+
+void CompressedTransport::decompress(const char *src, size_t n,
+                                     void *buf, size_t raw) {
+    bool ok = false;
+#ifdef BYLSOCKET_HAVE_LZ4
+    if (m_codec == Codec::LZ4) {
+        int r = m_use_dict
+                ? LZ4_decompress_safe_usingDict(src, (char *) buf, (int) n,
+                                                (int) raw, m_dict.data(),
+                                                (int) m_dict.size())
+                : LZ4_decompress_safe(src, (char *) buf, (int) n, (int) raw);
+        ok = r >= 0 && (size_t) r == raw;
+    }
+#endif
+#ifdef BYLSOCKET_HAVE_ZSTD
+    if (m_codec == Codec::ZSTD) {
+        size_t r = m_use_dict
+                   ? ZSTD_decompress_usingDDict(m_ctx->dctx, buf, raw, src, n,
+                                                m_ctx->ddict)
+                   : ZSTD_decompressDCtx(m_ctx->dctx, buf, raw, src, n);
+        ok = !ZSTD_isError(r) && r == raw;
+    }
+#endif
+    (void) src, (void) n, (void) buf, (void) raw;
+    if (!ok) {
+        errno = EPROTO;
+        err_report_and_throw("decompress");
+    }
+}
+
+void CompressedTransport::send_frame(const void *data, size_t len) {
+    m_raw_bytes += len;
+    size_t n = 0;
+    if (m_codec != Codec::NONE && len >= m_threshold && len <= MAX_FRAME)
+        n = compress(data, len);
+    if (n) {
+        // codec, raw length
+        char hdr[5];
+        hdr[0] = (char) m_codec;
+        uint32_t raw = htonl((uint32_t) len);
+        memcpy(hdr + 1, &raw, 4);
+        send_parts(hdr, sizeof hdr, m_tx.data(), n);
+        m_wire_bytes += 4 + sizeof hdr + n;
+    } else {
+        char hdr = (char) Codec::NONE;
+        send_parts(&hdr, 1, data, len);
+        m_wire_bytes += 4 + 1 + len;
+    }
+}
+
+size_t CompressedTransport::recv_frame(void *buf, size_t cap) {
+    uint32_t prefix;
+    read_full(m_fd, &prefix, sizeof prefix);
+    size_t len = ntohl(prefix);
+    char codec;
+    if (len < 1) {
+        errno = EPROTO;
+        err_report_and_throw("recv_frame: empty frame");
+    }
+    read_full(m_fd, &codec, 1);
+    --len;
+    if (codec == (char) Codec::NONE) {
+        if (len > cap) {
+            skip(len);
+            errno = EMSGSIZE;
+            err_report_and_throw("recv_frame: frame larger than buffer");
+        }
+        read_full(m_fd, buf, len);
+        return len;
+    }
+    uint32_t raw;
+    if (codec != (char) m_codec || len < sizeof raw) {
+        errno = EPROTO;
+        err_report_and_throw("recv_frame: unexpected codec");
+    }
+    read_full(m_fd, &raw, sizeof raw);
+    raw = ntohl(raw);
+    len -= sizeof raw;
+    if (raw > cap || raw > MAX_FRAME || len > MAX_FRAME) {
+        // nothing sane is that long, the stream is lost then anyway
+        if (len <= MAX_FRAME)
+            skip(len);
+        errno = EMSGSIZE;
+        err_report_and_throw("recv_frame: frame larger than buffer");
+    }
+    if (m_rx.size() < len)
+        m_rx.resize(len);
+    read_full(m_fd, m_rx.data(), len);
+    decompress(m_rx.data(), len, buf, raw);
+    return raw;
+}
+
+}
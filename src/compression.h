@@ -0,0 +1,90 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_COMPRESSION_H
+#define BYLSOCKET_COMPRESSION_H
+#include "transport.h"
+#include <string>
+#include <vector>
+
+namespace bylSocket {
+
+enum class Codec : uint8_t {
+    NONE = 0,
+    LZ4 = 1,
+    ZSTD = 2
+};
+
+inline unsigned codec_bit(Codec c) { return 1u << (unsigned) c; }
+
+struct CompressionOptions {
+    //! codec_bit()s this end accepts, limited to the compiled in ones
+    unsigned codecs = ~0u;
+    //! frames smaller than this go out uncompressed
+    size_t threshold = 256;
+    //! zstd level, lz4 acceleration
+    int level = 1;
+    /**
+     * raw or trained (`zstd --train`) dictionary, used only when the
+     * peer has the very same one
+     */
+    std::string dictionary;
+};
+
+/**
+ * SocketTransport compressing each frame on its own.
+ *
+ * construction exchanges a hello frame (magic, codec mask, dictionary
+ * hash) and both ends settle on the best codec they have in common,
+ * zstd over lz4 over none. a frame then carries one codec byte, and the
+ * raw length when compressed. frames below the threshold, or which
+ * wouldn't shrink, are sent as is.
+ *
+ * compression contexts and scratch buffers live as long as the
+ * transport, so a frame costs no allocation once they've grown.
+ *
+ * lz4 and zstd are optional at build time (BYLSOCKET_WITH_LZ4/ZSTD),
+ * available() tells what this build has.
+ */
+class CompressedTransport : public SocketTransport {
+public:
+    //! blocks until the peer's hello arrived
+    explicit CompressedTransport(int sock,
+                                 const CompressionOptions &opt = CompressionOptions());
+    virtual ~CompressedTransport();
+
+    virtual void send_frame(const void *data, size_t len) override;
+    virtual size_t recv_frame(void *buf, size_t cap) override;
+
+    Codec codec() const { return m_codec; }
+    bool uses_dictionary() const { return m_use_dict; }
+    //! payload bytes handed to send_frame, and what went on the wire for them
+    uint64_t raw_bytes() const { return m_raw_bytes; }
+    uint64_t wire_bytes() const { return m_wire_bytes; }
+
+    //! codec_bit()s compiled in, NONE is always there
+    static unsigned available();
+    static bool available(Codec c) { return (available() & codec_bit(c)) != 0; }
+private:
+    struct Contexts;
+    static const size_t MAX_FRAME = 64 << 20;
+
+    void handshake(const CompressionOptions &opt);
+    size_t compress(const void *data, size_t len);
+    void decompress(const char *src, size_t n, void *buf, size_t raw);
+
+    Codec m_codec;
+    bool m_use_dict;
+    size_t m_threshold;
+    int m_level;
+    std::string m_dict;
+    Contexts *m_ctx;
+    std::vector<char> m_tx;
+    std::vector<char> m_rx;
+    uint64_t m_raw_bytes;
+    uint64_t m_wire_bytes;
+};
+
+}
+#endif //BYLSOCKET_COMPRESSION_H
@@ -0,0 +1,123 @@
+//
+// Created on 10/19/26.
+//
+#include "connection_table.h"
+#include <cstring>
+
+namespace bylSocket {
+
+const ConnectionTable::Handle ConnectionTable::INVALID;
+
+ConnectionTable::~ConnectionTable() {
+    for_each([this](Handle h) { close(h); });
+}
+
+ConnectionTable::Handle ConnectionTable::open(int fd, uint64_t user) {
+    if (fd < 0) {
+        errno = EBADF;
+        err_report_and_throw("open");
+    }
+    if ((size_t) fd >= m_slots.size()) {
+        // grow geometrically, new slots are closed (generation 0)
+        size_t n = m_slots.empty() ? 1024 : m_slots.size();
+        while (n <= (size_t) fd)
+            n *= 2;
+        m_slots.resize(n, Slot{0, 0, nullptr, 0});
+    }
+    Slot &s = m_slots[fd];
+    if (s.gen & 1) {
+        errno = EEXIST;
+        err_report_and_throw("open");
+    }
+    ++s.gen;
+    s.len = 0;
+    s.buf = nullptr;
+    s.user = user;
+    ++m_open;
+    return make_handle(s.gen, fd);
+}
+
+bool ConnectionTable::close(Handle h) {
+    if (!valid(h))
+        return false;
+    Slot &s = m_slots[fd(h)];
+    detach(s);
+    ++s.gen;
+    --m_open;
+    ::close(fd(h));
+    return true;
+}
+
+bool ConnectionTable::valid(Handle h) const {
+    size_t i = (size_t) fd(h);
+    uint32_t gen = (uint32_t) (h >> 32);
+    return i < m_slots.size() && (gen & 1) && m_slots[i].gen == gen;
+}
+
+ConnectionTable::Handle ConnectionTable::lookup(int fd) const {
+    if (fd < 0 || (size_t) fd >= m_slots.size() || !(m_slots[fd].gen & 1))
+        return INVALID;
+    return make_handle(m_slots[fd].gen, fd);
+}
+
+ssize_t ConnectionTable::fill(Handle h) {
+    Slot &s = slot(h);
+    if (!s.buf) {
+        s.buf = m_pool.get();
+        ++m_buffers;
+    }
+    size_t room = m_pool.buf_size() - s.len;
+    if (room == 0) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    ssize_t n;
+    do {
+        n = ::recv(fd(h), s.buf + s.len, room, MSG_DONTWAIT);
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) {
+        s.len += (uint32_t) n;
+    } else if (s.len == 0) {
+        int saved = errno;
+        detach(s);
+        errno = saved;
+    }
+    return n;
+}
+
+void ConnectionTable::consume(Handle h, size_t n) {
+    Slot &s = slot(h);
+    assert_n_throw(n <= s.len);
+    s.len -= (uint32_t) n;
+    if (s.len == 0)
+        detach(s);
+    else
+        memmove(s.buf, s.buf + n, s.len);
+}
+
+size_t ConnectionTable::memory_bytes() const {
+    return m_slots.capacity() * sizeof(Slot) + m_buffers * m_pool.buf_size();
+}
+
+ConnectionTable::Slot &ConnectionTable::slot(Handle h) {
+    if (!valid(h)) {
+        errno = EBADF;
+        err_report_and_throw("stale connection handle");
+    }
+    return m_slots[fd(h)];
+}
+
+const ConnectionTable::Slot &ConnectionTable::slot(Handle h) const {
+    return const_cast<ConnectionTable *>(this)->slot(h);
+}
+
+void ConnectionTable::detach(Slot &s) {
+    if (s.buf) {
+        m_pool.put(s.buf);
+        s.buf = nullptr;
+        --m_buffers;
+    }
+    s.len = 0;
+}
+
+}
@@ -0,0 +1,107 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_CONNECTION_TABLE_H
+#define BYLSOCKET_CONNECTION_TABLE_H
+#include "common.h"
+#include "buffer_pool.h"
+#include <cstdint>
+#include <vector>
+
+namespace bylSocket {
+
+/**
+ * registry of open connections for an event loop serving many mostly
+ * idle peers, indexed by fd in a dense array.
+ *
+ * a connection is named by a Handle, (generation << 32 | fd), which fits
+ * into epoll_event::data.u64. the generation of a slot is bumped on every
+ * open and close, so a handle still queued in an event batch after its fd
+ * got closed and reused is detected by valid() instead of hitting the new
+ * connection.
+ *
+ * a slot is 24 bytes. the receive buffer is taken from the pool only when
+ * there is data to read and handed back as soon as it's consumed, so an
+ * idle connection costs its slot and nothing else.
+ *
+ * N.B. the table owns the fds given to open(), and must only be used by
+ * one thread.
+ */
+class ConnectionTable {
+public:
+    typedef uint64_t Handle;
+    //! never returned by open()
+    static const Handle INVALID = 0;
+
+    explicit ConnectionTable(BufferPool &pool)
+            : m_pool(pool), m_open(0), m_buffers(0) {}
+    ConnectionTable(const ConnectionTable &) = delete;
+    ConnectionTable &operator=(const ConnectionTable &) = delete;
+    //! closes every connection still open
+    ~ConnectionTable();
+
+    //! take ownership of fd, user is an opaque word for the caller
+    Handle open(int fd, uint64_t user = 0);
+    //! close the fd and return its buffer, false for a stale handle
+    bool close(Handle h);
+    bool valid(Handle h) const;
+    //! handle of the connection open on fd, INVALID if none
+    Handle lookup(int fd) const;
+
+    static int fd(Handle h) { return (int) (h & 0xffffffffu); }
+    uint64_t user(Handle h) const { return slot(h).user; }
+    void set_user(Handle h, uint64_t user) { slot(h).user = user; }
+
+    /**
+     * read what's available into the connection's buffer (attached on
+     * demand), without blocking.
+     * @return bytes read, 0 on EOF, -1 with errno set (EAGAIN when there
+     *  was nothing to read, the buffer is then released again if empty,
+     *  ENOBUFS when the buffer is full and needs consume() first)
+     */
+    ssize_t fill(Handle h);
+    //! buffered bytes, nullptr when no buffer is attached
+    const char *data(Handle h) const { return slot(h).buf; }
+    size_t buffered(Handle h) const { return slot(h).len; }
+    //! drop n buffered bytes, the buffer goes back to the pool once empty
+    void consume(Handle h, size_t n);
+
+    //! open connections
+    size_t size() const { return m_open; }
+    size_t buffers_in_use() const { return m_buffers; }
+    //! user space bytes held for the connections: slots plus attached buffers
+    size_t memory_bytes() const;
+
+    //! call f(handle) for every open connection, f may close it
+    template<class F>
+    void for_each(F f) {
+        for (size_t i = 0; i < m_slots.size(); ++i)
+            if (m_slots[i].gen & 1)
+                f(make_handle(m_slots[i].gen, (int) i));
+    }
+
+private:
+    struct Slot {
+        //! odd while open
+        uint32_t gen;
+        uint32_t len;
+        char *buf;
+        uint64_t user;
+    };
+
+    static Handle make_handle(uint32_t gen, int fd) {
+        return (Handle) gen << 32 | (uint32_t) fd;
+    }
+    Slot &slot(Handle h);
+    const Slot &slot(Handle h) const;
+    void detach(Slot &s);
+
+    BufferPool &m_pool;
+    std::vector<Slot> m_slots;
+    size_t m_open;
+    size_t m_buffers;
+};
+
+}
+#endif //BYLSOCKET_CONNECTION_TABLE_H
@@ -0,0 +1,203 @@
+//
+// Created on 10/19/26.
+//
+#include "cpu_steering.h"
+#include "busy_poll.h"
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <linux/filter.h>
+
+namespace bylSocket {
+
+bool attach_cpu_steering(int fd, unsigned listeners) {
+    assert_n_throw(listeners > 0);
+    struct sock_filter code[] = {
+            // A = cpu of the packet, A %= listeners, return A
+            {BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t) (SKF_AD_OFF + SKF_AD_CPU)},
+            {BPF_ALU | BPF_MOD | BPF_K, 0, 0, listeners},
+            {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    struct sock_fprog prog;
+    prog.len = sizeof code / sizeof code[0];
+    prog.filter = code;
+    return setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                      &prog, sizeof prog) == 0;
+}
+
+int incoming_cpu(int fd) {
+    int cpu = -1;
+    socklen_t len = sizeof cpu;
+    if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) == -1)
+        return -1;
+    return cpu;
+}
+
+namespace Tmpl {
+
+template<Domain D>
+struct CpuListeners<D>::Worker {
+    Worker(unsigned c, int lfd) : cpu(c), listen_fd(lfd),
+                                  wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+                                  stop(false), served(0), handed_on(0), foreign(0) {
+        if (wake_fd == -1)
+            err_report_and_throw("eventfd");
+    }
+    ~Worker() {
+        for (auto &c : inbox)
+            close(c.first);
+        if (close(wake_fd) == -1)
+            err_report("close");
+    }
+    void wake() {
+        uint64_t one = 1;
+        if (write(wake_fd, &one, sizeof one) == -1)
+            err_report("write eventfd");
+    }
+
+    const unsigned cpu;
+    const int listen_fd;
+    const int wake_fd;
+    EventLoop loop;
+    //! (fd, cpu it arrived on) handed on by other workers
+    std::mutex mtx;
+    std::vector<std::pair<int, int>> inbox;
+    std::atomic<bool> stop;
+    std::atomic<uint64_t> served;
+    std::atomic<uint64_t> handed_on;
+    std::atomic<uint64_t> foreign;
+    std::thread thread;
+};
+
+template<Domain D>
+CpuListeners<D>::CpuListeners(const char *port, const char *local, Handler h,
+                              unsigned cpus, Steering want)
+        : m_handler(std::move(h)), m_steering(want) {
+    assert_n_throw(m_handler);
+    if (!cpus)
+        cpus = (unsigned) sysconf(_SC_NPROCESSORS_ONLN);
+    // the i-th to listen is the i-th of the reuseport group
+    for (unsigned i = 0; i < cpus; ++i) {
+        m_listeners.emplace_back(port, local);
+        int fd = m_listeners.back().fd();
+        int flags = fcntl(fd, F_GETFL);
+        if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+            err_report_and_throw("fcntl");
+    }
+    int fd = m_listeners[0].fd();
+    if (m_steering == Steering::CBPF && !attach_cpu_steering(fd, cpus))
+        m_steering = Steering::INCOMING_CPU;
+    int cpu;
+    socklen_t len = sizeof cpu;
+    if (m_steering == Steering::INCOMING_CPU
+        && getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) == -1)
+        m_steering = Steering::NONE;
+
+    for (unsigned i = 0; i < cpus; ++i)
+        m_workers.emplace_back(new Worker(i, m_listeners[i].fd()));
+    for (auto &w : m_workers)
+        w->thread = std::thread(&CpuListeners::run, this, std::ref(*w));
+}
+
+template<Domain D>
+CpuListeners<D>::~CpuListeners() {
+    for (auto &w : m_workers) {
+        w->stop = true;
+        w->wake();
+    }
+    for (auto &w : m_workers)
+        w->thread.join();
+}
+
+template<Domain D>
+void CpuListeners<D>::run(Worker &w) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof allowed, &allowed) == 0
+        && CPU_ISSET(w.cpu, &allowed))
+        pin_thread((int) w.cpu);
+    w.loop.add(w.listen_fd, EPOLLIN, [this, &w](uint32_t) { on_accept(w); });
+    w.loop.add(w.wake_fd, EPOLLIN, [this, &w](uint32_t) {
+        uint64_t n;
+        if (read(w.wake_fd, &n, sizeof n) == -1 && errno != EAGAIN)
+            err_report("read eventfd");
+        std::vector<std::pair<int, int>> handed;
+        {
+            std::lock_guard<std::mutex> lk(w.mtx);
+            handed.swap(w.inbox);
+        }
+        for (auto &c : handed)
+            serve(w, c.first, c.second);
+    });
+    while (!w.stop)
+        w.loop.run_once();
+    w.loop.remove(w.listen_fd);
+    w.loop.remove(w.wake_fd);
+}
+
+template<Domain D>
+void CpuListeners<D>::on_accept(Worker &w) {
+    // a batch at most, then the other events of this loop
+    for (int i = 0; i < 64; ++i) {
+        int fd = accept4(w.listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return;
+            if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO)
+                continue;
+            err_report("accept4");
+            return;
+        }
+        int cpu = incoming_cpu(fd);
+        if (m_steering == Steering::INCOMING_CPU && cpu >= 0
+            && (unsigned) cpu < m_workers.size() && (unsigned) cpu != w.cpu) {
+            Worker &o = *m_workers[cpu];
+            {
+                std::lock_guard<std::mutex> lk(o.mtx);
+                o.inbox.push_back(std::make_pair(fd, cpu));
+            }
+            o.wake();
+            ++w.handed_on;
+            continue;
+        }
+        serve(w, fd, cpu);
+    }
+}
+
+template<Domain D>
+void CpuListeners<D>::serve(Worker &w, int fd, int arrived_on) {
+    if (arrived_on >= 0 && (unsigned) arrived_on != w.cpu)
+        ++w.foreign;
+    ++w.served;
+    m_handler(fd, w.loop);
+}
+
+template<Domain D>
+typename CpuListeners<D>::Stats CpuListeners<D>::stats(unsigned cpu) const {
+    assert_n_throw(cpu < m_workers.size());
+    const Worker &w = *m_workers[cpu];
+    Stats s;
+    s.served = w.served;
+    s.handed_on = w.handed_on;
+    s.foreign = w.foreign;
+    return s;
+}
+
+template<Domain D>
+typename CpuListeners<D>::Stats CpuListeners<D>::stats() const {
+    Stats sum;
+    for (unsigned i = 0; i < cpus(); ++i) {
+        Stats s = stats(i);
+        sum.served += s.served;
+        sum.handed_on += s.handed_on;
+        sum.foreign += s.foreign;
+    }
+    return sum;
+}
+
+template
+class CpuListeners<Domain::IP4>;
+template
+class CpuListeners<Domain::IP6>;
+
+}
+}
@@ -0,0 +1,98 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_CPU_STEERING_H
+#define BYLSOCKET_CPU_STEERING_H
+#include "tmpl_socket.h"
+#include "event_loop.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace bylSocket {
+
+enum class Steering {
+    //! SO_ATTACH_REUSEPORT_CBPF: the kernel picks the listener of the cpu
+    CBPF,
+    //! SO_INCOMING_CPU: hashed to any listener, handed on to the cpu's thread
+    INCOMING_CPU,
+    //! hashed to any listener, served there
+    NONE
+};
+
+/**
+ * attach a classic bpf program to the reuseport group of fd returning
+ * the cpu a new connection's handshake was processed on, modulo
+ * listeners: the i-th listener to join the group gets those of cpu i.
+ * @return false if the kernel doesn't support it
+ */
+bool attach_cpu_steering(int fd, unsigned listeners);
+//! cpu that last processed fd's packets, -1 if unknown
+int incoming_cpu(int fd);
+
+namespace Tmpl {
+
+/**
+ * one REUSEPORT listener per cpu on the same port, each served by its
+ * own EventLoop thread pinned to that cpu.
+ *
+ * with Steering::CBPF each connection is accepted by the thread of the
+ * cpu its packets arrive on, so its data stays in that cpu's caches.
+ * where the kernel can't, it falls back to Steering::INCOMING_CPU: the
+ * kernel's hash picks any listener and that thread hands the connection
+ * on to the thread of SO_INCOMING_CPU, and then to Steering::NONE.
+ *
+ * the cpus are 0 .. cpus-1, threads on cpus outside the process'
+ * affinity run unpinned.
+ */
+template<Domain D>
+class CpuListeners {
+    static_assert(D == Domain::IP4 || D == Domain::IP6, "cpu steering needs an IP domain");
+public:
+    /**
+     * called on the serving cpu's thread, takes the accepted fd
+     * (SOCK_CLOEXEC) over, loop is the thread's own
+     */
+    typedef std::function<void(int fd, EventLoop &loop)> Handler;
+
+    struct Stats {
+        //! connections handed to the Handler
+        uint64_t served = 0;
+        //! accepted by one thread, served by another
+        uint64_t handed_on = 0;
+        //! served on another cpu than the one they arrived on
+        uint64_t foreign = 0;
+    };
+
+    /**
+     * @param cpus 0 for all online cpus
+     * @param want the steering to try first
+     */
+    CpuListeners(const char *port, const char *local, Handler h,
+                 unsigned cpus = 0, Steering want = Steering::CBPF);
+    ~CpuListeners();
+    CpuListeners(const CpuListeners &) = delete;
+    CpuListeners &operator=(const CpuListeners &) = delete;
+
+    Steering steering() const { return m_steering; }
+    unsigned cpus() const { return (unsigned) m_workers.size(); }
+    Stats stats() const;
+    //! stats of the thread of one cpu
+    Stats stats(unsigned cpu) const;
+private:
+    struct Worker;
+
+    void run(Worker &w);
+    void on_accept(Worker &w);
+    void serve(Worker &w, int fd, int arrived_on);
+
+    Handler m_handler;
+    Steering m_steering;
+    std::vector<ListenedSocket<D>> m_listeners;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+};
+
+}
+}
+#endif //BYLSOCKET_CPU_STEERING_H
@@ -0,0 +1,148 @@
+//
+// Created on 10/19/26.
+//
+#include "event_loop.h"
+#include "metrics.h"
+#include <sys/timerfd.h>
+
+namespace bylSocket {
+
+EventLoop::EventLoop() : m_epfd(epoll_create1(EPOLL_CLOEXEC)), m_stop(false),
+                         m_events(256), m_timerfd(-1), m_armed(0),
+                         m_next_timer(0) {
+    if (m_epfd == -1)
+        err_report_and_throw("epoll_create1");
+}
+
+EventLoop::~EventLoop() {
+    if (m_timerfd != -1 && close(m_timerfd) == -1)
+        err_report("close");
+    if (close(m_epfd) == -1)
+        err_report("close");
+}
+
+void EventLoop::add(int fd, uint32_t events, Handler h) {
+    assert_n_throw(fd >= 0 && h);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof ev);
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        err_report_and_throw("epoll_ctl add");
+    if ((size_t) fd >= m_handlers.size())
+        m_handlers.resize(fd + 1);
+    m_handlers[fd] = std::make_shared<Handler>(std::move(h));
+}
+
+void EventLoop::modify(int fd, uint32_t events) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof ev);
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epfd, EPOLL_CTL_MOD, fd, &ev) == -1)
+        err_report_and_throw("epoll_ctl mod");
+}
+
+void EventLoop::remove(int fd) {
+    if (!watching(fd))
+        return;
+    if (epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, nullptr) == -1)
+        err_report("epoll_ctl del");
+    m_handlers[fd].reset();
+}
+
+bool EventLoop::watching(int fd) const {
+    return fd >= 0 && (size_t) fd < m_handlers.size() && m_handlers[fd];
+}
+
+void EventLoop::prepare_timers() {
+    if (m_timerfd != -1)
+        return;
+    m_timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (m_timerfd == -1)
+        err_report_and_throw("timerfd_create");
+    add(m_timerfd, EPOLLIN, [this](uint32_t) { run_timers(); });
+}
+
+EventLoop::TimerId EventLoop::add_timer(uint64_t delay_ns, TimerCallback f) {
+    assert_n_throw(f);
+    prepare_timers();
+    TimerId id = ++m_next_timer;
+    m_timers[id] = std::move(f);
+    m_deadlines.push(Deadline(now_ns() + delay_ns, id));
+    arm_timerfd();
+    return id;
+}
+
+bool EventLoop::cancel_timer(TimerId id) {
+    // its deadline stays in the heap until it comes up
+    return m_timers.erase(id) != 0;
+}
+
+void EventLoop::run_timers() {
+    uint64_t expirations;
+    if (read(m_timerfd, &expirations, sizeof expirations) == -1
+        && errno != EAGAIN)
+        err_report("read timerfd");
+    m_armed = 0;
+    uint64_t now = now_ns();
+    while (!m_deadlines.empty() && m_deadlines.top().first <= now) {
+        TimerId id = m_deadlines.top().second;
+        m_deadlines.pop();
+        auto it = m_timers.find(id);
+        if (it == m_timers.end())
+            continue;
+        TimerCallback f = std::move(it->second);
+        m_timers.erase(it);
+        // may add and cancel timers
+        f();
+    }
+    arm_timerfd();
+}
+
+void EventLoop::arm_timerfd() {
+    while (!m_deadlines.empty() && !m_timers.count(m_deadlines.top().second))
+        m_deadlines.pop();
+    if (m_deadlines.empty() || m_deadlines.top().first == m_armed)
+        return;
+    uint64_t deadline = m_deadlines.top().first;
+    struct itimerspec its;
+    memset(&its, 0, sizeof its);
+    // 0 would disarm, deadlines already passed fire right away
+    its.it_value.tv_sec = (time_t) (deadline / 1000000000);
+    its.it_value.tv_nsec = (long) (deadline % 1000000000);
+    if (!deadline)
+        its.it_value.tv_nsec = 1;
+    if (timerfd_settime(m_timerfd, TFD_TIMER_ABSTIME, &its, nullptr) == -1)
+        err_report_and_throw("timerfd_settime");
+    m_armed = deadline;
+}
+
+int EventLoop::run_once(int timeout_ms) {
+    int n = epoll_wait(m_epfd, m_events.data(), (int) m_events.size(),
+                       timeout_ms);
+    if (n == -1) {
+        if (errno == EINTR)
+            return 0;
+        err_report_and_throw("epoll_wait");
+    }
+    for (int i = 0; i < n; ++i) {
+        int fd = m_events[i].data.fd;
+        if (!watching(fd))
+            continue;
+        // keeps the handler alive even if it removes itself
+        std::shared_ptr<Handler> h = m_handlers[fd];
+        (*h)(m_events[i].events);
+    }
+    if ((size_t) n == m_events.size())
+        m_events.resize(m_events.size() * 2);
+    return n;
+}
+
+void EventLoop::run() {
+    m_stop = false;
+    while (!m_stop)
+        run_once();
+}
+
+}
@@ -0,0 +1,88 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_EVENT_LOOP_H
+#define BYLSOCKET_EVENT_LOOP_H
+#include "common.h"
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include <sys/epoll.h>
+
+namespace bylSocket {
+
+/**
+ * minimal level triggered epoll reactor, one per thread.
+ *
+ * handlers are looked up by fd on every event, so removing an fd (even
+ * from within a handler) drops its events still pending in the batch.
+ *
+ * one shot timers are kept in a heap, a timerfd armed for the earliest
+ * one wakes the loop up with ns resolution.
+ *
+ * N.B. fds are not owned, remove() them before closing.
+ */
+class EventLoop {
+public:
+    typedef std::function<void(uint32_t events)> Handler;
+    typedef std::function<void()> TimerCallback;
+    //! never 0
+    typedef uint64_t TimerId;
+
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    void add(int fd, uint32_t events, Handler h);
+    void modify(int fd, uint32_t events);
+    void remove(int fd);
+    bool watching(int fd) const;
+
+    /**
+     * create the timerfd now rather than with the first timer, for users
+     * that must not fail to add one later (e.g. when out of fds)
+     */
+    void prepare_timers();
+    //! call f from run_once() once delay_ns have passed
+    TimerId add_timer(uint64_t delay_ns, TimerCallback f);
+    //! @return false if already run or cancelled
+    bool cancel_timer(TimerId id);
+    size_t timers() const { return m_timers.size(); }
+
+    /**
+     * wait for and dispatch one batch of events
+     * @param timeout_ms -1 to block
+     * @return number of events dispatched
+     */
+    int run_once(int timeout_ms = -1);
+    //! dispatch until stop()
+    void run();
+    //! make run() return after the current batch, for use in handlers
+    void stop() { m_stop = true; }
+
+    int fd() const { return m_epfd; }
+protected:
+    void run_timers();
+    void arm_timerfd();
+
+    int m_epfd;
+    bool m_stop;
+    //! indexed by fd
+    std::vector<std::shared_ptr<Handler>> m_handlers;
+    std::vector<struct epoll_event> m_events;
+
+    //! created with the first timer or by prepare_timers()
+    int m_timerfd;
+    //! deadline the timerfd is armed for, 0 if disarmed
+    uint64_t m_armed;
+    TimerId m_next_timer;
+    //! (deadline, id), cancelled ones are skipped when they come up
+    typedef std::pair<uint64_t, TimerId> Deadline;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> m_deadlines;
+    std::unordered_map<TimerId, TimerCallback> m_timers;
+};
+
+}
+#endif //BYLSOCKET_EVENT_LOOP_H
@@ -0,0 +1,91 @@
+//
+// Created on 10/19/26.
+//
+#include "fd_passing.h"
+
+namespace bylSocket {
+
+void send_fds(int sock, const int *fds, int nfds,
+              const void *data, size_t len) {
+    assert_n_throw(nfds > 0 && nfds <= MAX_PASSED_FDS);
+    char dummy = '\0';
+    if (!data || !len) {
+        data = &dummy;
+        len = 1;
+    }
+    struct iovec iov = {const_cast<void *>(data), len};
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)];
+        struct cmsghdr align;
+    } ctl;
+    memset(&ctl, 0, sizeof ctl);
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl.buf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+
+    if (::sendmsg(sock, &msg, MSG_NOSIGNAL) <= 0)
+        err_report_and_throw("sendmsg");
+}
+
+int recv_fds(int sock, int *fds, int max_fds, void *data, size_t len) {
+    assert_n_throw(max_fds > 0 && max_fds <= MAX_PASSED_FDS);
+    char dummy;
+    if (!data || !len) {
+        data = &dummy;
+        len = 1;
+    }
+    struct iovec iov = {data, len};
+
+    union {
+        char buf[CMSG_SPACE(sizeof(int) * MAX_PASSED_FDS)];
+        struct cmsghdr align;
+    } ctl;
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl.buf;
+    msg.msg_controllen = sizeof ctl.buf;
+
+    if (::recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) <= 0)
+        err_report_and_throw("recvmsg");
+
+    int n = 0;
+    for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+            continue;
+        int cnt = (int) ((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        const unsigned char *p = CMSG_DATA(cmsg);
+        for (int i = 0; i < cnt; ++i, p += sizeof(int)) {
+            int fd;
+            memcpy(&fd, p, sizeof fd);
+            if (n < max_fds)
+                fds[n++] = fd;
+            // surplus fds would leak otherwise
+            else if (close(fd) == -1)
+                err_report("close");
+        }
+    }
+    if (msg.msg_flags & MSG_CTRUNC) {
+        for (int i = 0; i < n; ++i)
+            close(fds[i]);
+        errno = EMSGSIZE;
+        err_report_and_throw("recvmsg: control data truncated");
+    }
+    return n;
+}
+
+}
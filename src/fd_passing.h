@@ -0,0 +1,49 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_FD_PASSING_H
+#define BYLSOCKET_FD_PASSING_H
+#include "common.h"
+
+namespace bylSocket {
+
+//! upper bound of fds carried by one SCM_RIGHTS message (SCM_MAX_FD)
+static const int MAX_PASSED_FDS = 253;
+
+/**
+ * send fds over a connected unix domain socket as SCM_RIGHTS ancillary
+ * data, attached to the payload [data, data + len).
+ *
+ * N.B. at least one byte of payload is needed for the ancillary data to be
+ *      delivered, so an empty payload is replaced by a single '\0'.
+ *      the receiver still owns its own duplicates of the fds, the sender
+ *      may close its copies right after this call.
+ * @param sock connected unix domain socket fd
+ * @param fds
+ * @param nfds in [1, MAX_PASSED_FDS]
+ * @param data
+ * @param len
+ */
+void send_fds(int sock, const int *fds, int nfds,
+              const void *data = nullptr, size_t len = 0);
+
+/**
+ * receive fds sent by send_fds. received fds are close-on-exec and owned
+ * by the caller.
+ *
+ * for stream sockets, the ancillary data is bound to the first payload
+ * byte, thus the caller should read exactly the payload length the sender
+ * used (1 for the empty payload).
+ * @param sock
+ * @param fds out: receives at most max_fds fds
+ * @param max_fds
+ * @param data out: payload buffer, a 1 byte scratch is used if null
+ * @param len payload buffer size
+ * @return number of fds received, 0 if the message carried none
+ */
+int recv_fds(int sock, int *fds, int max_fds,
+             void *data = nullptr, size_t len = 0);
+
+}
+#endif //BYLSOCKET_FD_PASSING_H
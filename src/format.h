@@ -0,0 +1,240 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_FORMAT_H
+#define BYLSOCKET_FORMAT_H
+#include "util.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace bylSocket {
+
+/**
+ * type safe, allocation free (beyond the growth of out) formatting.
+ *
+ * "{}" is replaced by the next argument, "{:.N}" prints floating point
+ * with exactly N decimals, "{{" and "}}" are literal braces.
+ * floating point without precision prints at most 6 decimals with
+ * trailing zeros dropped, below 5e-7 that's 0. neither locale nor
+ * varargs is involved.
+ *
+ * e.g. format_to(s, "{} took {:.2}ms\n", "recv", 0.125) => "recv took 0.13ms\n"
+ */
+namespace fmt_detail {
+
+struct Spec {
+    int precision = -1;
+};
+
+//! writes v backwards ending at end, returns the first digit
+inline char *u64_to_chars(char *end, uint64_t v) {
+    static const char digits[] =
+            "00010203040506070809101112131415161718192021222324"
+            "25262728293031323334353637383940414243444546474849"
+            "50515253545556575859606162636465666768697071727374"
+            "75767778798081828384858687888990919293949596979899";
+    while (v >= 100) {
+        unsigned i = (unsigned) (v % 100) * 2;
+        v /= 100;
+        *--end = digits[i + 1];
+        *--end = digits[i];
+    }
+    if (v >= 10) {
+        unsigned i = (unsigned) v * 2;
+        *--end = digits[i + 1];
+        *--end = digits[i];
+    } else {
+        *--end = (char) ('0' + v);
+    }
+    return end;
+}
+
+inline void put(std::string &o, const Spec &, const char *s) {
+    o.append(s ? s : "(null)");
+}
+inline void put(std::string &o, const Spec &, const std::string &s) {
+    o.append(s);
+}
+inline void put(std::string &o, const Spec &, char c) { o.push_back(c); }
+inline void put(std::string &o, const Spec &, bool b) {
+    o.append(b ? "true" : "false");
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value
+                        && std::is_unsigned<T>::value>::type
+put(std::string &o, const Spec &, T v) {
+    char buf[24];
+    char *end = buf + sizeof buf;
+    char *p = u64_to_chars(end, v);
+    o.append(p, end - p);
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value
+                        && std::is_signed<T>::value>::type
+put(std::string &o, const Spec &, T v) {
+    char buf[24];
+    char *end = buf + sizeof buf;
+    // negate in unsigned to survive the minimum value
+    uint64_t u = v < 0 ? 0 - (uint64_t) v : (uint64_t) v;
+    char *p = u64_to_chars(end, u);
+    if (v < 0)
+        *--p = '-';
+    o.append(p, end - p);
+}
+
+inline void put(std::string &o, const Spec &spec, double v) {
+    static const uint64_t p10[] = {
+            1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+            10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+            100000000000ull, 1000000000000ull, 10000000000000ull,
+            100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+            100000000000000000ull, 1000000000000000000ull};
+    if (std::isnan(v)) {
+        o.append("nan");
+        return;
+    }
+    if (std::isinf(v)) {
+        o.append(v < 0 ? "-inf" : "inf");
+        return;
+    }
+    bool trim = spec.precision < 0;
+    int prec = trim ? 6 : spec.precision;
+    double a = std::fabs(v);
+    if (prec > 18 || a * p10[prec] >= 1e19) {
+        // out of the fixed point fast path
+        char buf[64];
+        int n = snprintf(buf, sizeof buf, "%.*g", trim ? 17 : prec, v);
+        o.append(buf, n);
+        return;
+    }
+    uint64_t scaled = (uint64_t) (a * p10[prec] + 0.5);
+    uint64_t ip = scaled / p10[prec], fp = scaled % p10[prec];
+    if (trim)
+        while (prec && fp % 10 == 0) {
+            fp /= 10;
+            --prec;
+        }
+    char buf[48];
+    char *end = buf + sizeof buf;
+    char *p = end;
+    if (prec) {
+        for (int i = 0; i < prec; ++i, fp /= 10)
+            *--p = (char) ('0' + fp % 10);
+        *--p = '.';
+    }
+    p = u64_to_chars(p, ip);
+    if (std::signbit(v) && scaled)
+        *--p = '-';
+    o.append(p, end - p);
+}
+inline void put(std::string &o, const Spec &spec, float v) {
+    put(o, spec, (double) v);
+}
+
+inline void put(std::string &o, const Spec &, const void *p) {
+    static const char hex[] = "0123456789abcdef";
+    char buf[2 + 2 * sizeof(uintptr_t)];
+    char *end = buf + sizeof buf;
+    char *q = end;
+    uintptr_t u = (uintptr_t) p;
+    do {
+        *--q = hex[u & 0xf];
+        u >>= 4;
+    } while (u);
+    *--q = 'x';
+    *--q = '0';
+    o.append(q, end - q);
+}
+
+//! copy up to the next placeholder, return at its '{' or the final '\0'
+inline const char *copy_literal(std::string &o, const char *f) {
+    for (;;) {
+        const char *p = f;
+        while (*p && *p != '{' && *p != '}')
+            ++p;
+        o.append(f, p - f);
+        if (!*p)
+            return p;
+        if (p[1] == *p) {
+            o.push_back(*p);
+            f = p + 2;
+        } else if (*p == '}') {
+            o.push_back('}');
+            f = p + 1;
+        } else {
+            return p;
+        }
+    }
+}
+
+//! parse "{...}" at f into spec, return past the '}'
+inline const char *parse_spec(const char *f, Spec &spec) {
+    ++f;
+    if (f[0] == ':' && f[1] == '.') {
+        f += 2;
+        spec.precision = 0;
+        while (*f >= '0' && *f <= '9')
+            spec.precision = spec.precision * 10 + (*f++ - '0');
+    }
+    if (*f != '}') {
+        errno = EINVAL;
+        err_report_and_throw("format: bad placeholder");
+    }
+    return f + 1;
+}
+
+constexpr const char *find_close(const char *s) {
+    return !*s || *s == '}' ? s : find_close(s + 1);
+}
+
+//! number of placeholders, usable in static_assert for literals
+constexpr unsigned count_placeholders(const char *s) {
+    return !*s ? 0
+               : (s[0] == '{' && s[1] == '{') ? count_placeholders(s + 2)
+               : s[0] == '{' ? 1 + count_placeholders(
+                    *find_close(s) ? find_close(s) + 1 : find_close(s))
+               : count_placeholders(s + 1);
+}
+
+}// fmt_detail
+
+inline void format_to(std::string &out, const char *format) {
+    if (*fmt_detail::copy_literal(out, format)) {
+        errno = EINVAL;
+        err_report_and_throw("format: more placeholders than arguments");
+    }
+}
+
+template<typename T, typename ... Args>
+void format_to(std::string &out, const char *format,
+               const T &v, const Args &... args) {
+    format = fmt_detail::copy_literal(out, format);
+    if (!*format) {
+        errno = EINVAL;
+        err_report_and_throw("format: more arguments than placeholders");
+    }
+    fmt_detail::Spec spec;
+    format = fmt_detail::parse_spec(format, spec);
+    fmt_detail::put(out, spec, v);
+    format_to(out, format, args...);
+}
+
+/**
+ * sock.send_fmt(format, ...) with the placeholders of a literal format
+ * counted against the arguments at compile time, there may be none
+ */
+#define checked_send_fmt(sock, format, ...) do { \
+    static_assert(bylSocket::fmt_detail::count_placeholders(format) \
+        == std::tuple_size<decltype(std::make_tuple(__VA_ARGS__))>::value, \
+        "format placeholders and arguments mismatch"); \
+    (sock).send_fmt(format, ##__VA_ARGS__); \
+} while(0)
+
+}
+#endif //BYLSOCKET_FORMAT_H
@@ -0,0 +1,108 @@
+//
+// Created on 10/19/26.
+//
+#include "handoff.h"
+#include "fd_passing.h"
+#include "tmpl_socket.h"
+#include <poll.h>
+
+namespace bylSocket {
+
+typedef Tmpl::Socket<Domain::UNIX, Type::SEQPACKET> CtlSocket;
+
+//! seconds to wait for the successor's acknowledgement
+static const time_t ACK_TIMEOUT = 5;
+
+static void send_batches(CtlSocket &s, const char *tag,
+                         const std::vector<int> &fds) {
+    for (size_t i = 0; i < fds.size(); i += MAX_PASSED_FDS) {
+        int n = (int) std::min(fds.size() - i, (size_t) MAX_PASSED_FDS);
+        s.send_fds(fds.data() + i, n, tag);
+    }
+}
+
+bool handoff_offer(const char *name,
+                   const std::vector<int> &listeners,
+                   const std::vector<int> &connections,
+                   int timeout_ms) {
+    std::unique_ptr<CtlSocket> conn;
+    {
+        CtlSocket ls;
+        ls.bind(name);
+        ls.listen(1);
+        struct pollfd p = {ls.fd(), POLLIN, 0};
+        int r;
+        while ((r = poll(&p, 1, timeout_ms)) == -1 && errno == EINTR);
+        if (r == -1)
+            err_report_and_throw("poll");
+        if (r == 0)
+            return false;
+        conn.reset(new CtlSocket(ls.accept()));
+        // name released here, the successor may offer under it
+    }
+    send_batches(*conn, "L", listeners);
+    send_batches(*conn, "C", connections);
+
+    Tmpl::BufferedSocket<Domain::UNIX, Type::SEQPACKET> bs(*conn);
+    bs.send("END");
+    bs.set_opt(Options::RCVTIMEO, ACK_TIMEOUT);
+    if (strcmp(bs.recv(), "ACK") != 0) {
+        errno = EPROTO;
+        err_report_and_throw("handoff: no ack");
+    }
+    return true;
+}
+
+bool handoff_take(const char *name, HandoffFds &out) {
+    CtlSocket s;
+    try {
+        s.connect(name);
+    } catch (std::exception &) {
+        return false;
+    }
+    for (;;) {
+        int fds[MAX_PASSED_FDS];
+        char tag[8] = {0};
+        int n = s.recv_fds(fds, MAX_PASSED_FDS, tag, sizeof tag - 1);
+        if (!strcmp(tag, "END"))
+            break;
+        std::vector<int> &v = tag[0] == 'L' ? out.listeners : out.connections;
+        v.insert(v.end(), fds, fds + n);
+    }
+    if (::send(s.fd(), "ACK", 4, MSG_NOSIGNAL) != 4)
+        err_report_and_throw("send");
+    return true;
+}
+
+bool Drainer::enter() {
+    std::lock_guard<std::mutex> g(m_mtx);
+    if (m_draining)
+        return false;
+    ++m_active;
+    return true;
+}
+
+void Drainer::leave() {
+    std::lock_guard<std::mutex> g(m_mtx);
+    assert(m_active > 0);
+    if (--m_active == 0)
+        m_cv.notify_all();
+}
+
+bool Drainer::drain(std::chrono::milliseconds deadline) {
+    std::unique_lock<std::mutex> g(m_mtx);
+    m_draining = true;
+    return m_cv.wait_for(g, deadline, [this]() { return m_active == 0; });
+}
+
+size_t Drainer::active() const {
+    std::lock_guard<std::mutex> g(m_mtx);
+    return m_active;
+}
+
+bool Drainer::draining() const {
+    std::lock_guard<std::mutex> g(m_mtx);
+    return m_draining;
+}
+
+}
@@ -0,0 +1,103 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_HANDOFF_H
+#define BYLSOCKET_HANDOFF_H
+#include "common.h"
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace bylSocket {
+
+/**
+ * zero downtime restart: the running process offers its listening fds
+ * (and optionally live connection fds) on an abstract unix socket, the
+ * new process takes them over via SCM_RIGHTS.
+ *
+ * the listening sockets themselves never close, so connections queued in
+ * the backlog are simply accepted by the new process, no RST and no
+ * connection refused in between. after a successful offer, the old
+ * process must stop calling accept() on its copies (just close them, the
+ * socket lives on in the successor; never shutdown() them, that would
+ * affect the successor too) and drain its connections, see Drainer.
+ *
+ * to be restartable again, the successor offers under the same name, the
+ * predecessor releases it before sending the fds.
+ */
+struct HandoffFds {
+    std::vector<int> listeners;
+    std::vector<int> connections;
+};
+
+/**
+ * wait for a successor on name and hand the fds over.
+ * the fds stay open in this process, they are duplicated into the other.
+ * @param name abstract unix socket name
+ * @param listeners
+ * @param connections
+ * @param timeout_ms how long to wait for a successor, -1 forever
+ * @return false on timeout
+ */
+bool handoff_offer(const char *name,
+                   const std::vector<int> &listeners,
+                   const std::vector<int> &connections = std::vector<int>(),
+                   int timeout_ms = -1);
+
+/**
+ * take over the fds offered by a predecessor.
+ * listening fds are adopted by Socket(fd, Status::LISTENING)
+ * @param name
+ * @param out
+ * @return false if no process offers under name
+ */
+bool handoff_take(const char *name, HandoffFds &out);
+
+/**
+ * counts connections in progress so shutdown can wait for them,
+ * up to a deadline.
+ */
+class Drainer {
+public:
+    Drainer() : m_active(0), m_draining(false) {}
+    Drainer(const Drainer &) = delete;
+    Drainer &operator=(const Drainer &) = delete;
+
+    //! false once draining, the connection should be refused then
+    bool enter();
+    void leave();
+
+    /**
+     * stop admitting and wait until all connections left
+     * @return false if some are still active at the deadline
+     */
+    bool drain(std::chrono::milliseconds deadline);
+
+    size_t active() const;
+    bool draining() const;
+
+    //! enter() on construction, leave() on destruction if admitted
+    class Guard {
+    public:
+        explicit Guard(Drainer &d) : m_d(d), m_admitted(d.enter()) {}
+        ~Guard() {
+            if (m_admitted)
+                m_d.leave();
+        }
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+        bool admitted() const { return m_admitted; }
+    private:
+        Drainer &m_d;
+        bool m_admitted;
+    };
+private:
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+    size_t m_active;
+    bool m_draining;
+};
+
+}
+#endif //BYLSOCKET_HANDOFF_H
@@ -0,0 +1,145 @@
+//
+// Created on 10/19/26.
+//
+#include "line_reader.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BYLSOCKET_X86_SIMD 1
+#endif
+
+namespace bylSocket {
+
+const char *find_byte_scalar(const char *p, size_t n, char c) {
+    for (const char *end = p + n; p != end; ++p)
+        if (*p == c)
+            return p;
+    return nullptr;
+}
+
+#ifdef BYLSOCKET_X86_SIMD
+__attribute__((target("sse2")))
+static const char *find_byte_sse2(const char *p, size_t n, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; n >= 16; p += 16, n -= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return find_byte_scalar(p, n, c);
+}
+
+__attribute__((target("avx2")))
+static const char *find_byte_avx2(const char *p, size_t n, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    for (; n >= 64; p += 64, n -= 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i b = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(p + 32));
+        unsigned ma = (unsigned) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(a, needle));
+        unsigned mb = (unsigned) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(b, needle));
+        if (ma | mb) {
+            uint64_t m = ma | (uint64_t) mb << 32;
+            return p + __builtin_ctzll(m);
+        }
+    }
+    for (; n >= 32; p += 32, n -= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        unsigned mask = (unsigned) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(v, needle));
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+    return find_byte_sse2(p, n, c);
+}
+
+typedef const char *(*FindByteFn)(const char *, size_t, char);
+
+static FindByteFn pick_find_byte() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return find_byte_avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return find_byte_sse2;
+    return find_byte_scalar;
+}
+
+const char *find_byte(const char *p, size_t n, char c) {
+    static const FindByteFn fn = pick_find_byte();
+    return fn(p, n, c);
+}
+#else
+const char *find_byte(const char *p, size_t n, char c) {
+    return find_byte_scalar(p, n, c);
+}
+#endif
+
+LineReader::LineReader(int fd, size_t max_record, size_t initial)
+        : m_fd(fd), m_max(max_record), m_buf(std::min(initial, max_record)),
+          m_begin(0), m_end(0), m_scanned(0), m_scanned_for('\n'), m_eof(false) {
+    // an empty buffer would read 0 bytes, i.e. look like eof
+    assert_n_throw(max_record > 0 && initial > 0);
+}
+
+bool LineReader::fill() {
+    if (m_end == m_buf.size()) {
+        if (m_begin) {
+            memmove(m_buf.data(), m_buf.data() + m_begin, m_end - m_begin);
+            m_end -= m_begin;
+            m_begin = 0;
+        } else if (m_buf.size() < m_max) {
+            m_buf.resize(std::min(m_buf.size() * 2, m_max));
+        } else {
+            errno = EMSGSIZE;
+            err_report_and_throw("read_until: record exceeds max_record");
+        }
+    }
+    for (;;) {
+        ssize_t n = ::recv(m_fd, m_buf.data() + m_end,
+                           m_buf.size() - m_end, 0);
+        if (n > 0) {
+            m_end += n;
+            return true;
+        }
+        if (n == 0)
+            return false;
+        if (errno != EINTR)
+            err_report_and_throw("recv");
+    }
+}
+
+bool LineReader::read_until(char delim, Slice &out) {
+    // a scan for another delimiter may be left over from a fill() throwing
+    if (delim != m_scanned_for) {
+        m_scanned = 0;
+        m_scanned_for = delim;
+    }
+    for (;;) {
+        const char *base = m_buf.data() + m_begin;
+        const char *hit = find_byte(base + m_scanned,
+                                    m_end - m_begin - m_scanned, delim);
+        if (hit) {
+            out.data = base;
+            out.size = hit - base;
+            m_begin += out.size + 1;
+            m_scanned = 0;
+            if (m_begin == m_end)
+                m_begin = m_end = 0;
+            return true;
+        }
+        m_scanned = m_end - m_begin;
+        if (m_eof || !fill()) {
+            m_eof = true;
+            if (m_begin == m_end)
+                return false;
+            out.data = m_buf.data() + m_begin;
+            out.size = m_end - m_begin;
+            m_begin = m_end = m_scanned = 0;
+            return true;
+        }
+    }
+}
+
+}
@@ -0,0 +1,76 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_LINE_READER_H
+#define BYLSOCKET_LINE_READER_H
+#include "common.h"
+#include <string>
+#include <vector>
+
+namespace bylSocket {
+
+//! non-owning view into a buffer
+struct Slice {
+    const char *data;
+    size_t size;
+
+    std::string str() const { return std::string(data, size); }
+};
+
+/**
+ * memchr class search for c in [p, p + n), nullptr if absent.
+ * dispatched once to avx2 or sse2 by cpu support, scalar elsewhere.
+ */
+const char *find_byte(const char *p, size_t n, char c);
+//! the plain byte loop, reference of find_byte
+const char *find_byte_scalar(const char *p, size_t n, char c);
+
+/**
+ * splits a stream socket into delimiter terminated records without
+ * copying them out: records are Slices into the internal receive buffer,
+ * valid until the next read_until.
+ *
+ * a record split across several recv()s is completed by later reads,
+ * already scanned bytes are not scanned again. the buffer grows up to
+ * max_record and is compacted in place.
+ *
+ * N.B. the fd is not owned.
+ */
+class LineReader {
+public:
+    static const size_t DEFAULT_MAX_RECORD = 1 << 20;
+
+    explicit LineReader(int fd,
+                        size_t max_record = DEFAULT_MAX_RECORD,
+                        size_t initial = 4096);
+
+    /**
+     * next record, delim excluded. at eof the unterminated remainder is
+     * returned as the last record.
+     * @param delim
+     * @param out
+     * @return false at eof when nothing is left
+     */
+    bool read_until(char delim, Slice &out);
+    bool read_line(Slice &out) { return read_until('\n', out); }
+
+    //! received but not yet consumed bytes
+    size_t buffered() const { return m_end - m_begin; }
+protected:
+    //! one recv() into the free tail, false at eof
+    bool fill();
+
+    int m_fd;
+    size_t m_max;
+    std::vector<char> m_buf;
+    size_t m_begin;
+    size_t m_end;
+    //! bytes after m_begin already known not to hold m_scanned_for
+    size_t m_scanned;
+    char m_scanned_for;
+    bool m_eof;
+};
+
+}
+#endif //BYLSOCKET_LINE_READER_H
@@ -0,0 +1,86 @@
+//
+// Created on 10/19/26.
+//
+#include "metrics.h"
+
+namespace bylSocket {
+
+Histogram::Histogram(int sub_bits)
+        : m_sub_bits(sub_bits),
+          m_counts((size_t) (65 - sub_bits) << sub_bits),
+          m_count(0), m_sum(0), m_min(UINT64_MAX), m_max(0) {
+    assert_n_throw(sub_bits > 0 && sub_bits < 16);
+}
+
+size_t Histogram::index(uint64_t v) const {
+    if (v < (1ull << m_sub_bits))
+        return (size_t) v;
+    int e = 63 - __builtin_clzll(v);
+    int shift = e - m_sub_bits;
+    // top sub_bits + 1 bits, the leading 1 picks the next bucket row
+    return ((size_t) (shift + 1) << m_sub_bits)
+           + (size_t) ((v >> shift) - (1ull << m_sub_bits));
+}
+
+uint64_t Histogram::value_at(size_t i) const {
+    size_t row = i >> m_sub_bits;
+    uint64_t sub = i & ((1u << m_sub_bits) - 1);
+    if (!row)
+        return sub;
+    return (sub + (1ull << m_sub_bits)) << (row - 1);
+}
+
+void Histogram::record_n(uint64_t v, uint64_t n) {
+    m_counts[index(v)] += n;
+    m_count += n;
+    m_sum += v * n;
+    if (v < m_min)
+        m_min = v;
+    if (v > m_max)
+        m_max = v;
+}
+
+void Histogram::merge(const Histogram &o) {
+    assert_n_throw(o.m_sub_bits == m_sub_bits);
+    for (size_t i = 0; i < m_counts.size(); ++i)
+        m_counts[i] += o.m_counts[i];
+    m_count += o.m_count;
+    m_sum += o.m_sum;
+    m_min = std::min(m_min, o.m_min);
+    m_max = std::max(m_max, o.m_max);
+}
+
+void Histogram::reset() {
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = m_sum = m_max = 0;
+    m_min = UINT64_MAX;
+}
+
+uint64_t Histogram::percentile(double p) const {
+    if (!m_count)
+        return 0;
+    uint64_t want = (uint64_t) (p / 100.0 * m_count + 0.5);
+    if (want < 1)
+        want = 1;
+    if (want >= m_count)
+        return m_max;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+        seen += m_counts[i];
+        if (seen >= want)
+            return std::min(std::max(value_at(i), min()), m_max);
+    }
+    return m_max;
+}
+
+void Histogram::print(FILE *f, const char *title, double unit_div) const {
+    fprintf(f, "%s n=%llu min=%.1f mean=%.1f p50=%.1f p90=%.1f p99=%.1f "
+               "p99.9=%.1f p99.99=%.1f max=%.1f\n",
+            title, (unsigned long long) m_count,
+            min() / unit_div, mean() / unit_div,
+            percentile(50) / unit_div, percentile(90) / unit_div,
+            percentile(99) / unit_div, percentile(99.9) / unit_div,
+            percentile(99.99) / unit_div, max() / unit_div);
+}
+
+}
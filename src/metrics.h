@@ -0,0 +1,63 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_METRICS_H
+#define BYLSOCKET_METRICS_H
+#include "common.h"
+#include <vector>
+
+namespace bylSocket {
+
+/**
+ * log-linear histogram in the manner of HdrHistogram: every power of 2
+ * range is split into 2^sub_bits linear sub-buckets, so any recorded
+ * value is reproduced within a relative error of 2^-sub_bits
+ * (0.8% by default) over the whole uint64_t range with fixed memory.
+ *
+ * meant for latencies in ns, one instance per thread, merge() to sum up.
+ */
+class Histogram {
+public:
+    explicit Histogram(int sub_bits = 7);
+
+    void record(uint64_t v) { record_n(v, 1); }
+    void record_n(uint64_t v, uint64_t n);
+    void merge(const Histogram &o);
+    void reset();
+
+    uint64_t count() const { return m_count; }
+    uint64_t min() const { return m_count ? m_min : 0; }
+    uint64_t max() const { return m_max; }
+    double mean() const { return m_count ? (double) m_sum / m_count : 0; }
+    /**
+     * @param p in [0, 100]
+     * @return the smallest recorded value (bucket) covering p percent
+     */
+    uint64_t percentile(double p) const;
+
+    /**
+     * one line summary: count, min, mean, p50/p90/p99/p99.9/p99.99, max
+     * @param unit_div divisor applied to the values, 1000 for ns -> us
+     */
+    void print(FILE *f, const char *title, double unit_div = 1000.0) const;
+protected:
+    size_t index(uint64_t v) const;
+    uint64_t value_at(size_t i) const;
+
+    int m_sub_bits;
+    std::vector<uint64_t> m_counts;
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_min;
+    uint64_t m_max;
+};
+
+//! monotonic clock in ns
+inline uint64_t now_ns() {
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+#endif //BYLSOCKET_METRICS_H
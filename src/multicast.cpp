@@ -0,0 +1,211 @@
+//
+// Created on 10/19/26.
+//
+#include "multicast.h"
+#include <net/if.h>
+#include <sys/uio.h>
+
+namespace bylSocket {
+
+SequenceGapDetector::Verdict SequenceGapDetector::track(uint64_t seq) {
+    ++m_received;
+    if (!m_started || seq >= m_next) {
+        Verdict v = Verdict::IN_ORDER;
+        if (m_started && seq > m_next) {
+            m_missing += seq - m_next;
+            ++m_gaps;
+            v = Verdict::GAP;
+        }
+        uint64_t shift = m_started ? seq - m_next + 1 : WINDOW;
+        m_window = shift >= WINDOW ? 0 : m_window << shift;
+        m_window |= 1;
+        m_next = seq + 1;
+        m_started = true;
+        return v;
+    }
+    uint64_t age = m_next - 1 - seq;
+    if (age >= WINDOW) {
+        ++m_stale;
+        return Verdict::STALE;
+    }
+    uint64_t bit = (uint64_t) 1 << age;
+    if (m_window & bit) {
+        ++m_duplicates;
+        return Verdict::DUPLICATE;
+    }
+    m_window |= bit;
+    --m_missing;
+    ++m_late;
+    return Verdict::LATE;
+}
+
+namespace Tmpl {
+
+template<Domain D>
+static int level() { return D == Domain::IP4 ? IPPROTO_IP : IPPROTO_IPV6; }
+
+template<Domain D>
+static void to_sockaddr(const char *addr, struct sockaddr_storage &ss) {
+    memset(&ss, 0, sizeof ss);
+    int r;
+    if (D == Domain::IP4) {
+        struct sockaddr_in *p = (struct sockaddr_in *) &ss;
+        p->sin_family = AF_INET;
+        r = inet_pton(AF_INET, addr, &p->sin_addr);
+    } else {
+        struct sockaddr_in6 *p = (struct sockaddr_in6 *) &ss;
+        p->sin6_family = AF_INET6;
+        r = inet_pton(AF_INET6, addr, &p->sin6_addr);
+    }
+    if (r <= 0) {
+        errno = EINVAL;
+        err_report_and_throw("inet_pton");
+    }
+}
+
+static unsigned ifindex(const char *iface) {
+    if (!iface || !*iface)
+        return 0;
+    unsigned i = if_nametoindex(iface);
+    if (!i)
+        err_report_and_throw("if_nametoindex");
+    return i;
+}
+
+template<Domain D>
+void MulticastSocket<D>::membership(int opt, const char *group, const char *source,
+                                    const char *iface) {
+    int r;
+    if (source) {
+        struct group_source_req req;
+        memset(&req, 0, sizeof req);
+        req.gsr_interface = ifindex(iface);
+        to_sockaddr<D>(group, req.gsr_group);
+        to_sockaddr<D>(source, req.gsr_source);
+        r = setsockopt(this->fd(), level<D>(), opt, &req, sizeof req);
+    } else {
+        struct group_req req;
+        memset(&req, 0, sizeof req);
+        req.gr_interface = ifindex(iface);
+        to_sockaddr<D>(group, req.gr_group);
+        r = setsockopt(this->fd(), level<D>(), opt, &req, sizeof req);
+    }
+    if (r == -1)
+        err_report_and_throw("setsockopt multicast membership");
+}
+
+template<Domain D>
+void MulticastSocket<D>::subscribe(const char *group, const char *port, const char *iface) {
+    this->set_opt(Options::REUSEADDR);
+    // only the groups joined by this very socket, not every group some
+    // socket of the host joined on this port
+    int off = 0;
+#ifdef IPV6_MULTICAST_ALL
+    int opt = D == Domain::IP4 ? IP_MULTICAST_ALL : IPV6_MULTICAST_ALL;
+#else
+    int opt = D == Domain::IP4 ? IP_MULTICAST_ALL : -1;
+#endif
+    if (opt != -1 && setsockopt(this->fd(), level<D>(), opt, &off, sizeof off) == -1)
+        err_report("setsockopt multicast all");
+    this->bind(group, port);
+    join(group, iface);
+}
+
+template<Domain D>
+void MulticastSocket<D>::join(const char *group, const char *iface) {
+    membership(MCAST_JOIN_GROUP, group, nullptr, iface);
+}
+
+template<Domain D>
+void MulticastSocket<D>::leave(const char *group, const char *iface) {
+    membership(MCAST_LEAVE_GROUP, group, nullptr, iface);
+}
+
+template<Domain D>
+void MulticastSocket<D>::join_source(const char *group, const char *source,
+                                     const char *iface) {
+    membership(MCAST_JOIN_SOURCE_GROUP, group, source, iface);
+}
+
+template<Domain D>
+void MulticastSocket<D>::leave_source(const char *group, const char *source,
+                                      const char *iface) {
+    membership(MCAST_LEAVE_SOURCE_GROUP, group, source, iface);
+}
+
+template<Domain D>
+void MulticastSocket<D>::set_loop(bool on) {
+    int v = on;
+    int opt = D == Domain::IP4 ? IP_MULTICAST_LOOP : IPV6_MULTICAST_LOOP;
+    if (setsockopt(this->fd(), level<D>(), opt, &v, sizeof v) == -1)
+        err_report_and_throw("setsockopt multicast loop");
+}
+
+template<Domain D>
+void MulticastSocket<D>::set_ttl(int hops) {
+    int opt = D == Domain::IP4 ? IP_MULTICAST_TTL : IPV6_MULTICAST_HOPS;
+    if (setsockopt(this->fd(), level<D>(), opt, &hops, sizeof hops) == -1)
+        err_report_and_throw("setsockopt multicast ttl");
+}
+
+template<Domain D>
+void MulticastSocket<D>::set_interface(const char *iface) {
+    int r;
+    if (D == Domain::IP4) {
+        struct ip_mreqn req;
+        memset(&req, 0, sizeof req);
+        req.imr_ifindex = (int) ifindex(iface);
+        r = setsockopt(this->fd(), IPPROTO_IP, IP_MULTICAST_IF, &req, sizeof req);
+    } else {
+        int i = (int) ifindex(iface);
+        r = setsockopt(this->fd(), IPPROTO_IPV6, IPV6_MULTICAST_IF, &i, sizeof i);
+    }
+    if (r == -1)
+        err_report_and_throw("setsockopt multicast interface");
+}
+
+template<Domain D>
+uint64_t MulticastSocket<D>::publish(const void *data, size_t len) {
+    uint64_t seq = m_seq++;
+    uint32_t hdr[2] = {htonl((uint32_t) (seq >> 32)), htonl((uint32_t) seq)};
+    struct iovec iov[2] = {{hdr, sizeof hdr},
+                           {const_cast<void *>(data), len}};
+    ssize_t n;
+    do {
+        n = ::writev(this->fd(), iov, 2);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0)
+        err_report_and_throw("publish");
+    return seq;
+}
+
+template<Domain D>
+size_t MulticastSocket<D>::receive(void *buf, size_t cap, uint64_t &seq) {
+    uint32_t hdr[2];
+    struct iovec iov[2] = {{hdr, sizeof hdr},
+                           {buf, cap}};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    ssize_t n;
+    do {
+        n = ::recvmsg(this->fd(), &msg, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0)
+        err_report_and_throw("receive");
+    if ((size_t) n < sizeof hdr) {
+        errno = EPROTO;
+        err_report_and_throw("receive: no sequence number");
+    }
+    seq = (uint64_t) ntohl(hdr[0]) << 32 | ntohl(hdr[1]);
+    return n - sizeof hdr;
+}
+
+template
+class MulticastSocket<Domain::IP4>;
+template
+class MulticastSocket<Domain::IP6>;
+
+}
+}
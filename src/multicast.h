@@ -0,0 +1,119 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_MULTICAST_H
+#define BYLSOCKET_MULTICAST_H
+#include "tmpl_socket.h"
+
+namespace bylSocket {
+
+/**
+ * sequence numbers of a feed as they arrive, to tell losses from
+ * reordering and duplicates.
+ *
+ * the last WINDOW numbers below the highest one seen are remembered, a
+ * missing one arriving within the window counts as late (and no longer
+ * missing), anything older is stale.
+ */
+class SequenceGapDetector {
+public:
+    enum class Verdict {
+        IN_ORDER,  //!< the next one expected
+        GAP,       //!< ahead of the next expected, the skipped are missing
+        LATE,      //!< a missing one, out of order
+        DUPLICATE, //!< seen already
+        STALE      //!< too old to tell
+    };
+    static const uint64_t WINDOW = 64;
+
+    Verdict track(uint64_t seq);
+
+    //! the next sequence number expected
+    uint64_t expected() const { return m_next; }
+    uint64_t received() const { return m_received; }
+    //! skipped and not (yet) arrived late
+    uint64_t missing() const { return m_missing; }
+    //! number of times the feed jumped ahead
+    uint64_t gaps() const { return m_gaps; }
+    uint64_t late() const { return m_late; }
+    uint64_t duplicates() const { return m_duplicates; }
+    uint64_t stale() const { return m_stale; }
+private:
+    bool m_started = false;
+    uint64_t m_next = 0;
+    //! bit i: m_next - 1 - i has arrived
+    uint64_t m_window = 0;
+    uint64_t m_received = 0;
+    uint64_t m_missing = 0;
+    uint64_t m_gaps = 0;
+    uint64_t m_late = 0;
+    uint64_t m_duplicates = 0;
+    uint64_t m_stale = 0;
+};
+
+namespace Tmpl {
+
+/**
+ * udp multicast, for Domain::IP4 and Domain::IP6.
+ *
+ * a receiver subscribe()s to group:port, any number of them may do so on
+ * the same host. a sender publish_to() a group, the kernel then makes the
+ * copies, one send reaches every subscriber.
+ *
+ * publish() prepends a 8 bytes big endian sequence number, receive()
+ * strips it, feed it to a SequenceGapDetector to spot losses.
+ *
+ * interfaces are given by name, e.g. "lo", nullptr lets the routing
+ * table choose.
+ */
+template<Domain D>
+class MulticastSocket : public Socket<D, Type::DGRAM> {
+    static_assert(D == Domain::IP4 || D == Domain::IP6,
+                  "multicast needs an IP domain");
+public:
+    MulticastSocket() : Socket<D, Type::DGRAM>() {}
+
+    /**
+     * REUSEADDR, bind to group:port and join the group. only datagrams
+     * of groups joined by this socket are delivered, even if others on
+     * the host joined more groups on the same port
+     */
+    void subscribe(const char *group, const char *port,
+                   const char *iface = nullptr);
+    void join(const char *group, const char *iface = nullptr);
+    void leave(const char *group, const char *iface = nullptr);
+    //! source specific: only datagrams from source are delivered
+    void join_source(const char *group, const char *source,
+                     const char *iface = nullptr);
+    void leave_source(const char *group, const char *source,
+                      const char *iface = nullptr);
+
+    //! deliver own datagrams to local subscribers too, on by default
+    void set_loop(bool on);
+    //! how many routers the datagrams may cross, 1 (this subnet) by default
+    void set_ttl(int hops);
+    //! send through iface instead of the route's
+    void set_interface(const char *iface);
+
+    //! connect to group:port for publish()
+    void publish_to(const char *group, const char *port) {
+        this->connect(group, port);
+    }
+    //! @return the sequence number it was sent with
+    uint64_t publish(const void *data, size_t len);
+    /**
+     * receive one datagram sent by publish(), block until available
+     * @return payload length, truncated to cap
+     */
+    size_t receive(void *buf, size_t cap, uint64_t &seq);
+private:
+    void membership(int opt, const char *group, const char *source,
+                    const char *iface);
+
+    uint64_t m_seq = 0;
+};
+
+}
+}
+#endif //BYLSOCKET_MULTICAST_H
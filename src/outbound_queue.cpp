@@ -0,0 +1,217 @@
+//
+// Created on 10/19/26.
+//
+#include "outbound_queue.h"
+#include "rate_limit.h"
+#include <algorithm>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+
+namespace bylSocket {
+
+bool MemoryBudget::try_acquire(size_t n) {
+    size_t used = m_used.load(std::memory_order_relaxed);
+    do {
+        if (used + n > limit() || used + n < used)
+            return false;
+    } while (!m_used.compare_exchange_weak(used, used + n,
+                                           std::memory_order_relaxed));
+    return true;
+}
+
+MemoryBudget &MemoryBudget::global() {
+    static MemoryBudget budget;
+    return budget;
+}
+
+OutboundQueue::OutboundQueue(int fd, size_t high, size_t low,
+                             MemoryBudget *budget)
+        : m_fd(fd), m_high(high), m_low(low), m_budget(budget),
+          m_front_off(0), m_queued(0), m_paused(false), m_limiter(nullptr),
+          m_loop(nullptr), m_timer(0) {
+    assert_n_throw(low <= high && budget);
+}
+
+OutboundQueue::~OutboundQueue() {
+    m_budget->release(m_queued);
+    if (m_timer)
+        m_loop->cancel_timer(m_timer);
+}
+
+size_t OutboundQueue::try_write(const char *p, size_t len) {
+    if (m_limiter) {
+        size_t granted = m_limiter->grant(len);
+        if (granted < len)
+            throttle(len - granted);
+        len = granted;
+        if (!len)
+            return 0;
+    }
+    for (;;) {
+        ssize_t n = ::send(m_fd, p, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (m_limiter)
+            m_limiter->refund(n >= 0 ? len - n : len);
+        if (n >= 0)
+            return (size_t) n;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        err_report_and_throw("send");
+    }
+}
+
+size_t OutboundQueue::write_reserved(const char *p, size_t len) {
+    size_t n = 0;
+    if (m_chunks.empty()) {
+        try {
+            n = try_write(p, len);
+        } catch (...) {
+            m_budget->release(len);
+            throw;
+        }
+    }
+    m_budget->release(n);
+    return n;
+}
+
+void OutboundQueue::push(const Chunk &c, size_t off) {
+    if (m_chunks.empty())
+        m_front_off = off;
+    m_chunks.push_back(c);
+}
+
+void OutboundQueue::check_high() {
+    if (!m_paused && m_queued >= m_high) {
+        m_paused = true;
+        if (m_on_high)
+            m_on_high();
+    }
+}
+
+bool OutboundQueue::send(const void *data, size_t len) {
+    if (!m_budget->try_acquire(len))
+        return false;
+    const char *p = static_cast<const char *>(data);
+    size_t n = write_reserved(p, len);
+    if (n == len)
+        return true;
+    m_queued += len - n;
+    push(std::make_shared<const std::string>(p + n, len - n), 0);
+    check_high();
+    return true;
+}
+
+bool OutboundQueue::send(const Chunk &c) {
+    size_t len = c->size();
+    if (!m_budget->try_acquire(len))
+        return false;
+    size_t n = write_reserved(c->data(), len);
+    if (n == len)
+        return true;
+    m_queued += len - n;
+    push(c, n);
+    check_high();
+    return true;
+}
+
+bool OutboundQueue::flush() {
+    while (!m_chunks.empty()) {
+        struct iovec iov[64];
+        int cnt = 0;
+        for (auto it = m_chunks.begin();
+             it != m_chunks.end() && cnt < 64; ++it, ++cnt) {
+            size_t off = cnt ? 0 : m_front_off;
+            iov[cnt].iov_base = const_cast<char *>((*it)->data()) + off;
+            iov[cnt].iov_len = (*it)->size() - off;
+        }
+        size_t granted = 0;
+        if (m_limiter) {
+            size_t total = 0;
+            for (int i = 0; i < cnt; ++i)
+                total += iov[i].iov_len;
+            granted = m_limiter->grant(total);
+            if (granted < total)
+                throttle(total - granted);
+            if (!granted)
+                break;
+            // cut the batch down to what's granted
+            size_t left = granted;
+            for (int i = 0; i < cnt; ++i) {
+                if (iov[i].iov_len >= left) {
+                    iov[i].iov_len = left;
+                    cnt = i + 1;
+                    break;
+                }
+                left -= iov[i].iov_len;
+            }
+        }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof msg);
+        msg.msg_iov = iov;
+        msg.msg_iovlen = cnt;
+        ssize_t n = ::sendmsg(m_fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (m_limiter)
+            m_limiter->refund(n < 0 ? granted : granted - n);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            err_report_and_throw("sendmsg");
+        }
+        m_queued -= n;
+        m_budget->release(n);
+        while (n) {
+            size_t left = m_chunks.front()->size() - m_front_off;
+            if ((size_t) n < left) {
+                m_front_off += n;
+                break;
+            }
+            n -= left;
+            m_chunks.pop_front();
+            m_front_off = 0;
+        }
+        // out of tokens, don't dribble out what trickles in meanwhile
+        if (throttled())
+            break;
+    }
+    if (m_paused && m_queued <= m_low) {
+        m_paused = false;
+        if (m_on_low)
+            m_on_low();
+    }
+    return m_chunks.empty();
+}
+
+void OutboundQueue::set_rate_limit(RateLimiter *limiter, EventLoop *loop) {
+    assert_n_throw(!limiter || loop);
+    if (m_timer) {
+        m_loop->cancel_timer(m_timer);
+        m_timer = 0;
+    }
+    m_limiter = limiter;
+    m_loop = loop;
+}
+
+void OutboundQueue::throttle(size_t pending) {
+    if (m_timer)
+        return;
+    // everything waiting, up to what fits at once: fewer, larger writes
+    size_t n = std::min(m_queued + pending, m_limiter->burst());
+    m_timer = m_loop->add_timer(m_limiter->wait_ns(n), [this]() {
+        m_timer = 0;
+        if (m_on_resume)
+            m_on_resume();
+        else
+            flush();
+    });
+}
+
+void OutboundQueue::set_notsent_lowat(int bytes) {
+    if (setsockopt(m_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT,
+                   &bytes, sizeof bytes) == -1)
+        err_report_and_throw("setsockopt TCP_NOTSENT_LOWAT");
+}
+
+}
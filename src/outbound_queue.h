@@ -0,0 +1,141 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_OUTBOUND_QUEUE_H
+#define BYLSOCKET_OUTBOUND_QUEUE_H
+#include "common.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+
+namespace bylSocket {
+
+class EventLoop;
+class RateLimiter;
+
+/**
+ * cap on the bytes held by a group of OutboundQueues,
+ * shared by all connections of a process by default
+ */
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t limit = SIZE_MAX) : m_used(0), m_limit(limit) {}
+    MemoryBudget(const MemoryBudget &) = delete;
+    MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+    //! reserve n bytes, false if that would exceed the limit
+    bool try_acquire(size_t n);
+    void release(size_t n) { m_used.fetch_sub(n, std::memory_order_relaxed); }
+
+    size_t used() const { return m_used.load(std::memory_order_relaxed); }
+    size_t limit() const { return m_limit.load(std::memory_order_relaxed); }
+    void set_limit(size_t limit) { m_limit.store(limit); }
+
+    //! process wide budget, unlimited until set_limit
+    static MemoryBudget &global();
+private:
+    std::atomic<size_t> m_used;
+    std::atomic<size_t> m_limit;
+};
+
+/**
+ * non-blocking, per connection write path.
+ *
+ * send() writes straight to the socket while nothing is queued and keeps
+ * whatever the kernel didn't take. the owner calls flush() whenever the
+ * socket turns writable (EPOLLOUT) until it returns true.
+ *
+ * crossing the high watermark fires on_high (e.g. stop reading from the
+ * producer of this data), draining down to the low watermark fires on_low.
+ *
+ * N.B. the fd is not owned, and a queue must only be used by one thread.
+ */
+class OutboundQueue {
+public:
+    //! immutable payload, may be shared by several queues
+    typedef std::shared_ptr<const std::string> Chunk;
+
+    static const size_t DEFAULT_HIGH = 1 << 20;
+    static const size_t DEFAULT_LOW = 256 << 10;
+
+    explicit OutboundQueue(int fd,
+                           size_t high = DEFAULT_HIGH,
+                           size_t low = DEFAULT_LOW,
+                           MemoryBudget *budget = &MemoryBudget::global());
+    ~OutboundQueue();
+    OutboundQueue(const OutboundQueue &) = delete;
+    OutboundQueue &operator=(const OutboundQueue &) = delete;
+
+    /**
+     * @return false if rejected by the memory budget, nothing is sent then
+     */
+    bool send(const void *data, size_t len);
+    bool send(const Chunk &c);
+
+    /**
+     * write out queued data without blocking, throw on socket errors
+     * @return true when the queue has been emptied
+     */
+    bool flush();
+
+    size_t queued() const { return m_queued; }
+    bool empty() const { return m_chunks.empty(); }
+    //! between crossing high and draining to low
+    bool paused() const { return m_paused; }
+
+    void on_high(std::function<void()> f) { m_on_high = std::move(f); }
+    void on_low(std::function<void()> f) { m_on_low = std::move(f); }
+
+    /**
+     * let the socket report writable only while less than bytes are
+     * unsent in the kernel (TCP_NOTSENT_LOWAT), which keeps the data
+     * buffered in the kernel small, only for tcp sockets
+     */
+    void set_notsent_lowat(int bytes);
+
+    /**
+     * pace writes by limiter, what it doesn't grant yet waits for a timer
+     * of loop, which calls on_resume (flush() by default). the socket may
+     * well be writable meanwhile, so don't wait for EPOLLOUT while
+     * throttled(). nullptr removes the limit
+     */
+    void set_rate_limit(RateLimiter *limiter, EventLoop *loop);
+    bool throttled() const { return m_timer != 0; }
+    void on_resume(std::function<void()> f) { m_on_resume = std::move(f); }
+
+    int fd() const { return m_fd; }
+protected:
+    //! non-blocking send, bytes written or 0 for EAGAIN
+    size_t try_write(const char *p, size_t len);
+    /**
+     * try_write len bytes reserved from the budget unless something is
+     * queued already, gives back what's written, all of it if that throws
+     */
+    size_t write_reserved(const char *p, size_t len);
+    void push(const Chunk &c, size_t off);
+    void check_high();
+    //! wait for the limiter to grant what's queued plus pending, up to its burst
+    void throttle(size_t pending);
+
+    int m_fd;
+    size_t m_high;
+    size_t m_low;
+    MemoryBudget *m_budget;
+    std::deque<Chunk> m_chunks;
+    //! bytes of the front chunk already written
+    size_t m_front_off;
+    size_t m_queued;
+    bool m_paused;
+    std::function<void()> m_on_high;
+    std::function<void()> m_on_low;
+    RateLimiter *m_limiter;
+    EventLoop *m_loop;
+    //! EventLoop::TimerId of a throttled queue, 0 otherwise
+    uint64_t m_timer;
+    std::function<void()> m_on_resume;
+};
+
+}
+#endif //BYLSOCKET_OUTBOUND_QUEUE_H
@@ -0,0 +1,183 @@
+//
+// Created on 10/19/26.
+//
+#include "pipeline.h"
+#include <vector>
+
+namespace bylSocket {
+
+static bool send_all(int fd, const char *p, size_t len) {
+    while (len) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static void put_u32(std::string &s, uint32_t v) {
+    v = htonl(v);
+    s.append((const char *) &v, sizeof v);
+}
+
+static uint32_t get_u32(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof v);
+    return ntohl(v);
+}
+
+PipelinedClient::PipelinedClient(int sock, size_t max_in_flight)
+        : m_fd(dup(sock)), m_max_in_flight(max_in_flight ? max_in_flight : 1),
+          m_next_id(0), m_writing(false), m_err(0), m_writes(0), m_requests(0) {
+    if (m_fd == -1)
+        err_report_and_throw("dup");
+    m_reader = std::thread(&PipelinedClient::reader, this);
+}
+
+PipelinedClient::~PipelinedClient() {
+    shutdown(m_fd, SHUT_RDWR);
+    m_reader.join();
+    if (close(m_fd) == -1)
+        err_report("close");
+}
+
+void PipelinedClient::call(const void *req, size_t len, Callback cb) {
+    if (len > MAX_FRAME - 4) {
+        errno = EMSGSIZE;
+        err_report_and_throw("call");
+    }
+    std::unique_lock<std::mutex> lk(m_mtx);
+    m_window.wait(lk, [&]() {
+        return m_err || m_pending.size() < m_max_in_flight;
+    });
+    if (m_err) {
+        int err = m_err;
+        lk.unlock();
+        cb(err, std::string());
+        return;
+    }
+    uint32_t id = m_next_id++;
+    m_pending.emplace(id, std::move(cb));
+    put_u32(m_outbox, (uint32_t) len + 4);
+    put_u32(m_outbox, id);
+    m_outbox.append((const char *) req, len);
+    ++m_requests;
+    if (m_writing)
+        return; // the current writer picks it up
+    m_writing = true;
+    std::string batch;
+    while (!m_outbox.empty() && !m_err) {
+        batch.swap(m_outbox);
+        lk.unlock();
+        bool ok = send_all(m_fd, batch.data(), batch.size());
+        batch.clear();
+        lk.lock();
+        ++m_writes;
+        if (!ok) {
+            // the reader sees the shutdown and fails everything pending
+            shutdown(m_fd, SHUT_RDWR);
+            break;
+        }
+    }
+    m_writing = false;
+}
+
+std::future<std::string> PipelinedClient::call(const void *req, size_t len) {
+    auto p = std::make_shared<std::promise<std::string>>();
+    call(req, len, [p](int err, std::string &&resp) {
+        if (err)
+            p->set_exception(std::make_exception_ptr(std::logic_error(strerror(err))));
+        else
+            p->set_value(std::move(resp));
+    });
+    return p->get_future();
+}
+
+size_t PipelinedClient::in_flight() const {
+    std::lock_guard<std::mutex> lk(m_mtx);
+    return m_pending.size();
+}
+
+uint64_t PipelinedClient::writes() const {
+    std::lock_guard<std::mutex> lk(m_mtx);
+    return m_writes;
+}
+
+uint64_t PipelinedClient::requests() const {
+    std::lock_guard<std::mutex> lk(m_mtx);
+    return m_requests;
+}
+
+void PipelinedClient::reader() {
+    std::vector<char> buf(64 << 10);
+    size_t have = 0;
+    int err = ECONNRESET;
+    for (;;) {
+        if (have == buf.size())
+            buf.resize(buf.size() * 2);
+        ssize_t n = ::recv(m_fd, &buf[have], buf.size() - have, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            if (n < 0)
+                err = errno;
+            break;
+        }
+        have += n;
+        size_t off = 0;
+        while (have - off >= 8) {
+            uint32_t len = get_u32(&buf[off]);
+            if (len < 4 || len > MAX_FRAME) {
+                err = EPROTO;
+                goto out;
+            }
+            if (have - off < 4 + (size_t) len) {
+                if (4 + (size_t) len > buf.size())
+                    buf.resize(4 + (size_t) len);
+                break;
+            }
+            uint32_t id = get_u32(&buf[off + 4]);
+            std::string resp(&buf[off + 8], len - 4);
+            off += 4 + len;
+
+            Callback cb;
+            {
+                std::lock_guard<std::mutex> lk(m_mtx);
+                auto it = m_pending.find(id);
+                if (it == m_pending.end()) {
+                    err = EPROTO;
+                    goto out;
+                }
+                cb = std::move(it->second);
+                m_pending.erase(it);
+            }
+            m_window.notify_one();
+            cb(0, std::move(resp));
+        }
+        if (off) {
+            memmove(&buf[0], &buf[off], have - off);
+            have -= off;
+        }
+    }
+out:
+    shutdown(m_fd, SHUT_RDWR);
+    fail_all(err);
+}
+
+void PipelinedClient::fail_all(int err) {
+    std::unordered_map<uint32_t, Callback> pending;
+    {
+        std::lock_guard<std::mutex> lk(m_mtx);
+        m_err = err;
+        pending.swap(m_pending);
+    }
+    m_window.notify_all();
+    for (auto &p : pending)
+        p.second(err, std::string());
+}
+
+}
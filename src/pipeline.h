@@ -0,0 +1,85 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_PIPELINE_H
+#define BYLSOCKET_PIPELINE_H
+#include "common.h"
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace bylSocket {
+
+/**
+ * request/response client keeping many requests in flight on one
+ * connected stream socket.
+ *
+ * every request and response is a SocketTransport frame whose payload
+ * starts with a 4 bytes big endian request id, so a server can be written
+ * with SocketTransport and answer in any order, echoing the id.
+ *
+ * call() may be used from any number of threads. a caller finding nobody
+ * writing becomes the writer and sends whatever the others queued
+ * meanwhile along with its own request, so concurrent requests share
+ * syscalls. responses are read by a background thread and matched by id.
+ *
+ * at most max_in_flight requests are outstanding, call() blocks beyond.
+ *
+ * N.B. the socket fd is dup()'ed, callbacks run on the reader thread and
+ * must not block on further responses.
+ */
+class PipelinedClient {
+public:
+    /**
+     * @param err 0 on success, else the errno the connection failed with
+     * @param response payload without the id
+     */
+    typedef std::function<void(int err, std::string &&response)> Callback;
+
+    static const size_t MAX_FRAME = 64 << 20;
+
+    explicit PipelinedClient(int sock, size_t max_in_flight = 1024);
+    PipelinedClient(const PipelinedClient &) = delete;
+    PipelinedClient &operator=(const PipelinedClient &) = delete;
+    //! shuts the connection down, pending requests fail with ECONNRESET
+    ~PipelinedClient();
+
+    void call(const void *req, size_t len, Callback cb);
+    //! the future throws std::logic_error if the connection fails
+    std::future<std::string> call(const void *req, size_t len);
+    std::future<std::string> call(const std::string &req) {
+        return call(req.data(), req.size());
+    }
+
+    size_t in_flight() const;
+    //! write syscalls made and requests sent, their ratio is the batching
+    uint64_t writes() const;
+    uint64_t requests() const;
+private:
+    void reader();
+    void fail_all(int err);
+
+    int m_fd;
+    const size_t m_max_in_flight;
+
+    mutable std::mutex m_mtx;
+    std::condition_variable m_window;
+    std::unordered_map<uint32_t, Callback> m_pending;
+    uint32_t m_next_id;
+    //! frames waiting for the current writer
+    std::string m_outbox;
+    bool m_writing;
+    int m_err;
+    uint64_t m_writes;
+    uint64_t m_requests;
+
+    std::thread m_reader;
+};
+
+}
+#endif //BYLSOCKET_PIPELINE_H
@@ -0,0 +1,68 @@
+//
+// Created on 10/19/26.
+//
+#include "poller.h"
+
+namespace bylSocket {
+
+Poller::Poller() : m_epfd(epoll_create1(EPOLL_CLOEXEC)), m_count(0) {
+    if (m_epfd == -1)
+        err_report_and_throw("epoll_create1");
+}
+
+Poller::~Poller() {
+    if (close(m_epfd) == -1)
+        err_report("close");
+}
+
+void Poller::add(int fd, uint32_t events, void *tag) {
+    assert_n_throw(fd >= 0);
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof ev);
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+        err_report_and_throw("epoll_ctl add");
+    if ((size_t) fd >= m_tags.size())
+        m_tags.resize(fd + 1);
+    m_tags[fd] = tag;
+    ++m_count;
+}
+
+void Poller::modify(int fd, uint32_t events) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof ev);
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(m_epfd, EPOLL_CTL_MOD, fd, &ev) == -1)
+        err_report_and_throw("epoll_ctl mod");
+}
+
+void Poller::remove(int fd) {
+    if (epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, nullptr) == -1)
+        err_report_and_throw("epoll_ctl del");
+    m_tags[fd] = nullptr;
+    --m_count;
+}
+
+const std::vector<Poller::Ready> &Poller::wait(int timeout_ms, const sigset_t *sigmask) {
+    m_ready.clear();
+    // room for every socket, so one call reports all that are ready
+    if (m_events.size() < m_count)
+        m_events.resize(m_count);
+    if (m_events.empty())
+        m_events.resize(1);
+    int n = epoll_pwait(m_epfd, m_events.data(), (int) m_events.size(), timeout_ms, sigmask);
+    if (n == -1) {
+        if (errno == EINTR)
+            return m_ready;
+        err_report_and_throw("epoll_pwait");
+    }
+    for (int i = 0; i < n; ++i) {
+        int fd = m_events[i].data.fd;
+        m_ready.push_back(Ready{fd, m_events[i].events, m_tags[fd]});
+    }
+    return m_ready;
+}
+
+}
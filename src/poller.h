@@ -0,0 +1,83 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_POLLER_H
+#define BYLSOCKET_POLLER_H
+#include "common.h"
+#include <csignal>
+#include <vector>
+#include <sys/epoll.h>
+
+namespace bylSocket {
+
+/**
+ * waits on a set of sockets at once, for blocking users that don't want
+ * a reactor: add the sockets, then loop over what wait() returns.
+ *
+ *     Poller p;
+ *     for (auto &s : sockets)
+ *         p.add(s);
+ *     for (;;)
+ *         for (auto &r : p.wait(1000))
+ *             if (r.events & EPOLLIN)
+ *                 handle(r.socket<Socket>());
+ *
+ * anything with an fd() works, Socket as well as Tmpl::Socket<D, T>.
+ *
+ * N.B. sockets are not owned and must stay in place while added,
+ * remove() them before they go away.
+ */
+class Poller {
+public:
+    struct Ready {
+        int fd;
+        //! EPOLLIN, EPOLLOUT, EPOLLERR, EPOLLHUP, ...
+        uint32_t events;
+        //! what was given to add()
+        void *tag;
+
+        template<class S>
+        S &socket() const { return *static_cast<S *>(tag); }
+    };
+
+    Poller();
+    ~Poller();
+    Poller(const Poller &) = delete;
+    Poller &operator=(const Poller &) = delete;
+
+    template<class S>
+    void add(S &sock, uint32_t events = EPOLLIN) {
+        add(sock.fd(), events, &sock);
+    }
+    template<class S>
+    void modify(S &sock, uint32_t events) { modify(sock.fd(), events); }
+    template<class S>
+    void remove(S &sock) { remove(sock.fd()); }
+
+    void add(int fd, uint32_t events, void *tag = nullptr);
+    void modify(int fd, uint32_t events);
+    void remove(int fd);
+    size_t size() const { return m_count; }
+
+    /**
+     * wait until at least one socket is ready, with one epoll_pwait for
+     * the whole set
+     * @param timeout_ms -1 to block
+     * @param sigmask signals to unblock while waiting, like ppoll
+     * @return the ready ones, empty on timeout or EINTR. valid until the
+     *  next wait()
+     */
+    const std::vector<Ready> &wait(int timeout_ms = -1,
+                                   const sigset_t *sigmask = nullptr);
+private:
+    int m_epfd;
+    size_t m_count;
+    //! indexed by fd, the tag given to add()
+    std::vector<void *> m_tags;
+    std::vector<struct epoll_event> m_events;
+    std::vector<Ready> m_ready;
+};
+
+}
+#endif //BYLSOCKET_POLLER_H
@@ -0,0 +1,130 @@
+//
+// Created on 10/19/26.
+//
+#include "rate_limit.h"
+#include <algorithm>
+
+namespace bylSocket {
+
+static const uint64_t NS_PER_SEC = 1000000000;
+
+TokenBucket::TokenBucket(uint64_t rate, uint64_t burst)
+        : m_rate(rate), m_burst(burst),
+          m_burst_ns(rate ? (uint64_t) ((unsigned __int128) burst * NS_PER_SEC / rate) : 0),
+          m_empty_at(0) {
+    assert_n_throw(!rate || burst);
+}
+
+uint64_t TokenBucket::cost_ns(uint64_t bytes) const {
+    // rounded up, so the rate is never exceeded
+    return (uint64_t) (((unsigned __int128) bytes * NS_PER_SEC + m_rate - 1) / m_rate);
+}
+
+size_t TokenBucket::take(size_t want, uint64_t now) {
+    if (!m_rate)
+        return want;
+    // a full bucket doesn't fill any further
+    uint64_t full = now > m_burst_ns ? now - m_burst_ns : 0;
+    uint64_t empty_at = m_empty_at.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t base = std::max(empty_at, full);
+        if (base >= now)
+            return 0;
+        uint64_t avail = (uint64_t) ((unsigned __int128) (now - base) * m_rate / NS_PER_SEC);
+        size_t n = (size_t) std::min<uint64_t>(std::min<uint64_t>(want, avail), m_burst);
+        if (!n)
+            return 0;
+        if (m_empty_at.compare_exchange_weak(empty_at, base + cost_ns(n),
+                                             std::memory_order_relaxed))
+            return n;
+    }
+}
+
+void TokenBucket::give_back(size_t n) {
+    if (!m_rate || !n)
+        return;
+    uint64_t cost = cost_ns(n);
+    uint64_t empty_at = m_empty_at.load(std::memory_order_relaxed);
+    while (!m_empty_at.compare_exchange_weak(
+            empty_at, empty_at > cost ? empty_at - cost : 0,
+            std::memory_order_relaxed)) {}
+}
+
+uint64_t TokenBucket::wait_ns(size_t n, uint64_t now) const {
+    if (!m_rate)
+        return 0;
+    uint64_t full = now > m_burst_ns ? now - m_burst_ns : 0;
+    uint64_t base = std::max(m_empty_at.load(std::memory_order_relaxed), full);
+    uint64_t ready = base + cost_ns(std::min<uint64_t>(n, m_burst));
+    return ready > now ? ready - now : 0;
+}
+
+RateLimiter::RateLimiter(uint64_t rate, uint64_t burst, TokenBucket *group)
+        : m_own(rate, burst), m_group(group), m_granted(0), m_throttled(0) {}
+
+size_t RateLimiter::grant(size_t want, uint64_t now) {
+    size_t n = m_own.take(want, now);
+    if (m_group && n) {
+        size_t g = m_group->take(n, now);
+        m_own.give_back(n - g);
+        n = g;
+    }
+    m_granted += n;
+    if (n < want)
+        ++m_throttled;
+    return n;
+}
+
+void RateLimiter::refund(size_t n) {
+    m_own.give_back(n);
+    if (m_group)
+        m_group->give_back(n);
+    m_granted -= n;
+}
+
+uint64_t RateLimiter::wait_ns(size_t n, uint64_t now) const {
+    uint64_t w = m_own.wait_ns(n, now);
+    if (m_group)
+        w = std::max(w, m_group->wait_ns(n, now));
+    return w;
+}
+
+size_t RateLimiter::burst() const {
+    size_t b = m_own.rate() ? m_own.burst() : SIZE_MAX;
+    if (m_group && m_group->rate())
+        b = std::min<size_t>(b, m_group->burst());
+    return b;
+}
+
+ssize_t RateLimiter::send(int fd, const void *buf, size_t len, int flags) {
+    size_t g = grant(len);
+    if (!g && len) {
+        errno = EAGAIN;
+        return -1;
+    }
+    ssize_t n = ::send(fd, buf, g, flags | MSG_DONTWAIT | MSG_NOSIGNAL);
+    refund(n < 0 ? g : g - n);
+    return n;
+}
+
+ssize_t RateLimiter::recv(int fd, void *buf, size_t len, int flags) {
+    size_t g = grant(len);
+    if (!g && len) {
+        errno = EAGAIN;
+        return -1;
+    }
+    ssize_t n = ::recv(fd, buf, g, flags | MSG_DONTWAIT);
+    refund(n < 0 ? g : g - n);
+    return n;
+}
+
+EventLoop::TimerId RateLimiter::defer(EventLoop &loop, int fd,
+                                     uint32_t events, size_t n) {
+    loop.modify(fd, 0);
+    return loop.add_timer(wait_ns(n), [&loop, fd, events]() {
+        if (loop.watching(fd))
+            loop.modify(fd, events);
+    });
+}
+
+}
@@ -0,0 +1,99 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_RATE_LIMIT_H
+#define BYLSOCKET_RATE_LIMIT_H
+#include "common.h"
+#include "event_loop.h"
+#include "metrics.h"
+#include <atomic>
+
+namespace bylSocket {
+
+/**
+ * token bucket of bytes: rate bytes per second flow in, at most burst
+ * are held.
+ *
+ * kept as the single time the bucket was (or will be) empty, updated by
+ * compare and swap, so one bucket can be shared by the connections of
+ * several threads, e.g. to cap a whole tenant.
+ */
+class TokenBucket {
+public:
+    //! @param rate bytes per second, 0 for unlimited
+    TokenBucket(uint64_t rate, uint64_t burst);
+    TokenBucket(const TokenBucket &) = delete;
+    TokenBucket &operator=(const TokenBucket &) = delete;
+
+    //! @return how much of want may go now, possibly 0
+    size_t take(size_t want, uint64_t now = now_ns());
+    //! return tokens taken but not used
+    void give_back(size_t n);
+    //! ns until n bytes (at most burst) may go at once
+    uint64_t wait_ns(size_t n, uint64_t now = now_ns()) const;
+
+    uint64_t rate() const { return m_rate; }
+    uint64_t burst() const { return m_burst; }
+private:
+    uint64_t cost_ns(uint64_t bytes) const;
+
+    const uint64_t m_rate;
+    const uint64_t m_burst;
+    const uint64_t m_burst_ns;
+    std::atomic<uint64_t> m_empty_at;
+};
+
+/**
+ * rate limit of one connection: its own bucket and optionally one of a
+ * group, the bytes granted are taken from both.
+ *
+ * send()/recv() move at most the granted bytes and fail with EAGAIN when
+ * out of tokens, defer() then stops watching the fd in the event loop
+ * until tokens are there again, rather than sleeping. OutboundQueue can
+ * be paced by one too, see OutboundQueue::set_rate_limit.
+ *
+ * Options::MAX_PACING_RATE is the kernel's alternative for tcp sends,
+ * paced per packet, but per socket only.
+ *
+ * N.B. a limiter must only be used by one thread, unlike the buckets.
+ */
+class RateLimiter {
+public:
+    //! @param rate bytes per second of this connection, 0 for unlimited
+    explicit RateLimiter(uint64_t rate = 0, uint64_t burst = 64 << 10,
+                         TokenBucket *group = nullptr);
+
+    //! @return how much of want may go now, possibly 0
+    size_t grant(size_t want, uint64_t now = now_ns());
+    void refund(size_t n);
+    //! ns until n bytes (at most either burst) may go at once
+    uint64_t wait_ns(size_t n, uint64_t now = now_ns()) const;
+    //! the largest grant possible at once
+    size_t burst() const;
+
+    //! non-blocking, -1 with EAGAIN when out of tokens too
+    ssize_t send(int fd, const void *buf, size_t len, int flags = 0);
+    ssize_t recv(int fd, void *buf, size_t len, int flags = 0);
+
+    /**
+     * watch fd for nothing until n bytes may go, then for events again.
+     * on the loop's timers, fd must stay added to the loop meanwhile.
+     * @return the timer, whoever closes fd before it fires must cancel
+     *         it: a new connection may get the same fd number
+     */
+    EventLoop::TimerId defer(EventLoop &loop, int fd, uint32_t events,
+                             size_t n = 1);
+
+    uint64_t granted() const { return m_granted; }
+    //! grants smaller than asked for
+    uint64_t throttled() const { return m_throttled; }
+private:
+    TokenBucket m_own;
+    TokenBucket *m_group;
+    uint64_t m_granted;
+    uint64_t m_throttled;
+};
+
+}
+#endif //BYLSOCKET_RATE_LIMIT_H
@@ -0,0 +1,290 @@
+//
+// Created on 10/19/26.
+//
+#include "relay.h"
+#include <fcntl.h>
+
+namespace bylSocket {
+
+struct Relay::Direction {
+    int src;
+    int dst;
+    //! splice pipe, -1 when copying through a buffer
+    int pipe[2];
+    char *buf;
+    size_t off;
+    //! bytes read from src, not yet written to dst
+    size_t pending;
+    bool eof;
+    bool shut;
+    //! blocked on dst being writable
+    bool blocked;
+    bool spliced;
+    uint64_t bytes;
+};
+
+struct Relay::Pair {
+    uint64_t id;
+    int fd[2];
+    Direction dir[2];
+    uint32_t interest[2];
+    //! fd i hung up, it's no longer polled
+    bool hup[2];
+    bool failed;
+    std::chrono::steady_clock::time_point start;
+    DoneCallback on_done;
+};
+
+static const size_t SPLICE_CHUNK = 64 << 10;
+//! rounds of a direction per event, keeps busy pairs from starving others
+static const int PUMP_ROUNDS = 16;
+
+Relay::Relay(EventLoop &loop, BufferPool &pool, bool use_splice)
+        : m_loop(loop), m_pool(pool), m_use_splice(use_splice), m_next_id(0),
+          m_done_bytes{0, 0} {}
+
+Relay::~Relay() {
+    while (!m_pairs.empty()) {
+        Pair &p = *m_pairs.begin()->second;
+        p.on_done = nullptr;
+        finish(p);
+    }
+}
+
+static int dup_nonblock(int fd) {
+    int d = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (d == -1)
+        err_report_and_throw("dup");
+    int fl = fcntl(d, F_GETFL);
+    if (fl == -1 || fcntl(d, F_SETFL, fl | O_NONBLOCK) == -1) {
+        close(d);
+        err_report_and_throw("fcntl O_NONBLOCK");
+    }
+    return d;
+}
+
+void Relay::add(int a, int b, DoneCallback on_done) {
+    std::unique_ptr<Pair> p(new Pair());
+    p->id = m_next_id++;
+    p->fd[0] = dup_nonblock(a);
+    try {
+        p->fd[1] = dup_nonblock(b);
+    } catch (...) {
+        close(p->fd[0]);
+        throw;
+    }
+    for (int i = 0; i < 2; ++i) {
+        Direction &d = p->dir[i];
+        d.src = p->fd[i];
+        d.dst = p->fd[1 - i];
+        d.pipe[0] = d.pipe[1] = -1;
+        d.buf = nullptr;
+        d.off = d.pending = 0;
+        d.eof = d.shut = d.blocked = d.spliced = false;
+        d.bytes = 0;
+        if (m_use_splice && pipe2(d.pipe, O_NONBLOCK | O_CLOEXEC) == -1) {
+            err_report("pipe2, relaying through buffers");
+            d.pipe[0] = d.pipe[1] = -1;
+        }
+    }
+    p->interest[0] = p->interest[1] = EPOLLIN;
+    p->hup[0] = p->hup[1] = false;
+    p->failed = false;
+    p->start = std::chrono::steady_clock::now();
+    p->on_done = std::move(on_done);
+
+    Pair *raw = p.get();
+    m_pairs[p->id] = std::move(p);
+    for (int i = 0; i < 2; ++i) {
+        m_loop.add(raw->fd[i], EPOLLIN, [this, raw, i](uint32_t ev) {
+            uint64_t id = raw->id;
+            if (ev & EPOLLERR) {
+                raw->failed = true;
+                finish(*raw);
+                return;
+            }
+            if (ev & EPOLLHUP) {
+                hang_up(*raw, i);
+                return;
+            }
+            // readable feeds direction i, writable unblocks direction 1 - i
+            if (ev & EPOLLOUT)
+                pump(*raw, 1 - i);
+            if (m_pairs.count(id) && (ev & EPOLLIN))
+                pump(*raw, i);
+        });
+    }
+}
+
+static void close_pipe(int *pp) {
+    if (pp[0] != -1) {
+        close(pp[0]);
+        close(pp[1]);
+        pp[0] = pp[1] = -1;
+    }
+}
+
+void Relay::pump(Pair &p, int i) {
+    Direction &d = p.dir[i];
+    if (p.failed || d.shut)
+        return;
+    // a hung up source never blocks and isn't polled anymore
+    for (int round = 0; round < PUMP_ROUNDS || p.hup[i]; ++round) {
+        // drain what's in flight first
+        while (d.pending) {
+            ssize_t n;
+            if (d.pipe[0] != -1)
+                n = splice(d.pipe[0], nullptr, d.dst, nullptr, d.pending,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            else
+                n = ::send(d.dst, d.buf + d.off, d.pending, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    d.blocked = true;
+                    update_interest(p);
+                    return;
+                }
+                err_report("relay write");
+                p.failed = true;
+                finish(p);
+                return;
+            }
+            d.pending -= n;
+            d.off += n;
+            d.bytes += n;
+        }
+        if (d.buf) {
+            m_pool.put(d.buf);
+            d.buf = nullptr;
+        }
+        d.off = 0;
+        d.blocked = false;
+
+        if (d.eof) {
+            if (::shutdown(d.dst, SHUT_WR) == -1 && errno != ENOTCONN)
+                err_report("shutdown");
+            d.shut = true;
+            close_pipe(d.pipe);
+            if (p.dir[1 - i].shut)
+                finish(p);
+            else
+                update_interest(p);
+            return;
+        }
+
+        ssize_t n;
+        for (;;) {
+            if (d.pipe[0] != -1) {
+                n = splice(d.src, nullptr, d.pipe[1], nullptr, SPLICE_CHUNK,
+                           SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (n < 0 && errno == EINVAL) {
+                    // this pair of fds can't be spliced
+                    close_pipe(d.pipe);
+                    continue;
+                }
+            } else {
+                if (!d.buf)
+                    d.buf = m_pool.get();
+                n = ::recv(d.src, d.buf, m_pool.buf_size(), 0);
+            }
+            if (n < 0 && errno == EINTR)
+                continue;
+            break;
+        }
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (d.buf) {
+                    m_pool.put(d.buf);
+                    d.buf = nullptr;
+                }
+                update_interest(p);
+                return;
+            }
+            err_report("relay read");
+            p.failed = true;
+            finish(p);
+            return;
+        }
+        if (n == 0)
+            d.eof = true;
+        else if (d.pipe[0] != -1)
+            d.spliced = true;
+        d.pending = n;
+    }
+    // out of rounds, carry on once dst reports writable
+    if (d.pending)
+        d.blocked = true;
+    update_interest(p);
+}
+
+void Relay::hang_up(Pair &p, int i) {
+    // nothing can be written to fd i anymore, what's left to read from it
+    // still goes out, driven by the other fd turning writable
+    p.hup[i] = true;
+    m_loop.remove(p.fd[i]);
+    Direction &out = p.dir[1 - i];
+    if (!out.shut) {
+        out.shut = true;
+        out.pending = 0;
+        close_pipe(out.pipe);
+        if (out.buf) {
+            m_pool.put(out.buf);
+            out.buf = nullptr;
+        }
+    }
+    if (p.dir[i].shut)
+        finish(p);
+    else
+        pump(p, i);
+}
+
+void Relay::update_interest(Pair &p) {
+    for (int i = 0; i < 2; ++i) {
+        if (p.hup[i])
+            continue;
+        // fd i is read by direction i and written by direction 1 - i
+        const Direction &in = p.dir[i], &out = p.dir[1 - i];
+        uint32_t want = 0;
+        if (!in.shut && !in.eof && !in.pending)
+            want |= EPOLLIN;
+        if (!out.shut && out.blocked)
+            want |= EPOLLOUT;
+        if (want != p.interest[i]) {
+            m_loop.modify(p.fd[i], want);
+            p.interest[i] = want;
+        }
+    }
+}
+
+void Relay::finish(Pair &p) {
+    Stats st;
+    st.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - p.start).count();
+    for (int i = 0; i < 2; ++i) {
+        Direction &d = p.dir[i];
+        st.bytes[i] = d.bytes;
+        st.spliced[i] = d.spliced;
+        m_done_bytes[i] += d.bytes;
+        close_pipe(d.pipe);
+        if (d.buf)
+            m_pool.put(d.buf);
+        m_loop.remove(p.fd[i]);
+        if (close(p.fd[i]) == -1)
+            err_report("close");
+    }
+    DoneCallback cb = std::move(p.on_done);
+    m_pairs.erase(p.id);
+    if (cb)
+        cb(st);
+}
+
+uint64_t Relay::total_bytes(int dir) const {
+    uint64_t n = m_done_bytes[dir];
+    for (auto &kv : m_pairs)
+        n += kv.second->dir[dir].bytes;
+    return n;
+}
+
+}
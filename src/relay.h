@@ -0,0 +1,73 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_RELAY_H
+#define BYLSOCKET_RELAY_H
+#include "event_loop.h"
+#include "buffer_pool.h"
+#include <chrono>
+#include <unordered_map>
+
+namespace bylSocket {
+
+/**
+ * bidirectional byte pump between pairs of connected stream sockets,
+ * any domain on either side, e.g. local unix clients to ip backends.
+ *
+ * each direction moves data with splice() through a pipe when the kernel
+ * supports it for both ends, otherwise through a buffer borrowed from the
+ * pool only while data is in flight. a direction stops reading while its
+ * destination doesn't take the data (backpressure), and an eof is
+ * forwarded as shutdown(SHUT_WR) once everything before it is written,
+ * so half-closed connections keep working. the pair is closed when both
+ * directions are done or on any error.
+ *
+ * the relay dup()s the given fds and switches them to non-blocking.
+ */
+class Relay {
+public:
+    struct Stats {
+        //! [0]: a -> b, [1]: b -> a
+        uint64_t bytes[2];
+        //! splice() was used for the direction
+        bool spliced[2];
+        double seconds;
+
+        //! bytes per second of direction i
+        double throughput(int i) const {
+            return seconds > 0 ? bytes[i] / seconds : 0;
+        }
+    };
+    typedef std::function<void(const Stats &)> DoneCallback;
+
+    Relay(EventLoop &loop, BufferPool &pool, bool use_splice = true);
+    ~Relay();
+    Relay(const Relay &) = delete;
+    Relay &operator=(const Relay &) = delete;
+
+    //! start relaying between a and b, on_done is called once closed
+    void add(int a, int b, DoneCallback on_done = nullptr);
+
+    size_t active() const { return m_pairs.size(); }
+    //! bytes of finished and active pairs, per direction
+    uint64_t total_bytes(int dir) const;
+
+    struct Pair;
+protected:
+    struct Direction;
+    void pump(Pair &p, int dir);
+    void hang_up(Pair &p, int i);
+    void update_interest(Pair &p);
+    void finish(Pair &p);
+
+    EventLoop &m_loop;
+    BufferPool &m_pool;
+    bool m_use_splice;
+    uint64_t m_next_id;
+    uint64_t m_done_bytes[2];
+    std::unordered_map<uint64_t, std::unique_ptr<Pair>> m_pairs;
+};
+
+}
+#endif //BYLSOCKET_RELAY_H
@@ -0,0 +1,280 @@
+//
+// Created on 10/19/26.
+//
+#include "shm_transport.h"
+#include "fd_passing.h"
+#include <new>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+
+namespace bylSocket {
+
+/**
+ * head/tail are free running byte counters, each record is
+ * [u32 len][u32 pad][payload padded to 8 bytes], a WRAP len tells the
+ * consumer to skip the rest of the ring.
+ */
+struct ShmTransport::RingHeader {
+    alignas(64) std::atomic<uint64_t> head;
+    std::atomic<uint32_t> producer_waiting;
+    alignas(64) std::atomic<uint64_t> tail;
+    std::atomic<uint32_t> consumer_waiting;
+    alignas(64) uint64_t capacity;
+
+    char *data() { return reinterpret_cast<char *>(this + 1); }
+};
+
+static const uint32_t WRAP = UINT32_MAX;
+static const size_t REC_HDR = 8;
+
+static inline size_t align8(size_t n) { return (n + 7) & ~(size_t) 7; }
+
+static void signal_evfd(int fd) {
+    uint64_t one = 1;
+    if (write(fd, &one, sizeof one) == -1 && errno != EAGAIN)
+        err_report("eventfd write");
+}
+
+ShmTransport::ShmTransport(int ctl, void *map, size_t map_len,
+                           const int *evfds, bool creator)
+        : m_ctl(ctl), m_map_len(map_len), m_map(map), m_spin(DEFAULT_SPIN) {
+    memcpy(m_evfd, evfds, sizeof m_evfd);
+    RingHeader *a = static_cast<RingHeader *>(m_map);
+    RingHeader *b = reinterpret_cast<RingHeader *>(
+            static_cast<char *>(m_map) + map_len / 2);
+    m_tx = creator ? a : b;
+    m_rx = creator ? b : a;
+}
+
+ShmTransport::~ShmTransport() {
+    if (munmap(m_map, m_map_len) == -1)
+        err_report("munmap");
+    for (int fd : m_evfd)
+        if (close(fd) == -1)
+            err_report("close");
+    if (close(m_ctl) == -1)
+        err_report("close");
+}
+
+static void *map_rings(int memfd, size_t map_len) {
+    void *map = mmap(nullptr, map_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     memfd, 0);
+    if (map == MAP_FAILED) {
+        close(memfd);
+        err_report_and_throw("mmap");
+    }
+    return map;
+}
+
+std::unique_ptr<ShmTransport>
+ShmTransport::create(int ctl, size_t ring_bytes) {
+    size_t cap = 4096;
+    while (cap < ring_bytes)
+        cap <<= 1;
+    size_t map_len = 2 * (sizeof(RingHeader) + cap);
+
+    int memfd = memfd_create("bylsocket_shm", MFD_CLOEXEC);
+    if (memfd == -1)
+        err_report_and_throw("memfd_create");
+    if (ftruncate(memfd, map_len) == -1) {
+        close(memfd);
+        err_report_and_throw("ftruncate");
+    }
+    void *map = map_rings(memfd, map_len);
+    // the rings are initialised before the peer can see them
+    for (int i = 0; i < 2; ++i) {
+        RingHeader *r = new(static_cast<char *>(map) + i * (map_len / 2))
+                RingHeader;
+        r->head.store(0);
+        r->tail.store(0);
+        r->producer_waiting.store(0);
+        r->consumer_waiting.store(0);
+        r->capacity = cap;
+    }
+
+    int fds[5] = {memfd, -1, -1, -1, -1};
+    int dfd = dup(ctl);
+    for (int i = 1; i < 5 && dfd != -1; ++i) {
+        fds[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fds[i] == -1)
+            break;
+    }
+    if (dfd == -1 || fds[4] == -1) {
+        int e = errno;
+        for (int fd : fds)
+            if (fd != -1)
+                close(fd);
+        if (dfd != -1)
+            close(dfd);
+        munmap(map, map_len);
+        errno = e;
+        err_report_and_throw("create");
+    }
+
+    std::unique_ptr<ShmTransport> t(
+            new ShmTransport(dfd, map, map_len, fds + 1, true));
+    try {
+        send_fds(ctl, fds, 5);
+    } catch (...) {
+        close(memfd);
+        throw;
+    }
+    if (close(memfd) == -1)
+        err_report("close");
+    return t;
+}
+
+std::unique_ptr<ShmTransport> ShmTransport::attach(int ctl) {
+    int fds[5];
+    int n = recv_fds(ctl, fds, 5);
+    struct stat st;
+    size_t map_len = 0;
+    void *map = MAP_FAILED;
+    int dfd = -1;
+    int e = 0;
+    // nothing of the shared memory is read before it's known to be there
+    if (n != 5)
+        e = EPROTO;
+    else if (fstat(fds[0], &st) == -1)
+        e = errno;
+    else if ((size_t) st.st_size < 2 * sizeof(RingHeader))
+        e = EPROTO;
+    if (!e) {
+        map_len = (size_t) st.st_size;
+        map = mmap(nullptr, map_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fds[0], 0);
+        if (map == MAP_FAILED)
+            e = errno;
+    }
+    if (!e) {
+        RingHeader *a = static_cast<RingHeader *>(map);
+        RingHeader *b = reinterpret_cast<RingHeader *>(
+                static_cast<char *>(map) + map_len / 2);
+        uint64_t cap = a->capacity;
+        if (!cap || (cap & (cap - 1)) || b->capacity != cap
+            || map_len != 2 * (sizeof(RingHeader) + cap))
+            e = EPROTO;
+    }
+    if (!e && (dfd = dup(ctl)) == -1)
+        e = errno;
+    if (e) {
+        if (map != MAP_FAILED)
+            munmap(map, map_len);
+        for (int i = 0; i < n; ++i)
+            close(fds[i]);
+        errno = e;
+        err_report_and_throw(e == EPROTO ? "attach: malformed shared ring"
+                                         : "attach");
+    }
+    close(fds[0]);
+
+    // the creator's rx is our tx
+    int ev[4] = {fds[3], fds[4], fds[1], fds[2]};
+    return std::unique_ptr<ShmTransport>(
+            new ShmTransport(dfd, map, map_len, ev, false));
+}
+
+size_t ShmTransport::max_frame() const {
+    return m_tx->capacity / 2 - REC_HDR;
+}
+
+template<typename Ready>
+void ShmTransport::park(int evfd, std::atomic<uint32_t> &waiting,
+                        Ready ready) {
+    for (unsigned i = 0; i < m_spin; ++i) {
+        if (ready())
+            return;
+        cpu_relax();
+    }
+    waiting.store(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!ready()) {
+        struct pollfd p[2] = {{evfd, POLLIN, 0}, {m_ctl, POLLIN, 0}};
+        if (poll(p, 2, -1) == -1) {
+            if (errno == EINTR)
+                continue;
+            waiting.store(0);
+            err_report_and_throw("poll");
+        }
+        // nothing flows on the control socket after the handshake
+        if (p[1].revents && !ready()) {
+            waiting.store(0);
+            errno = ECONNRESET;
+            err_report_and_throw("shm peer gone");
+        }
+        uint64_t v;
+        if (p[0].revents && read(evfd, &v, sizeof v) == -1
+            && errno != EAGAIN)
+            err_report("eventfd read");
+    }
+    waiting.store(0, std::memory_order_relaxed);
+}
+
+void ShmTransport::send_frame(const void *data, size_t len) {
+    assert_n_throw(len <= max_frame());
+    RingHeader &r = *m_tx;
+    const uint64_t cap = r.capacity;
+    const size_t need = REC_HDR + align8(len);
+    uint64_t head = r.head.load(std::memory_order_relaxed);
+    uint64_t pos = head & (cap - 1);
+    uint64_t contiguous = cap - pos;
+    uint64_t total = contiguous < need ? contiguous + need : need;
+
+    auto has_space = [&]() {
+        return cap - (head - r.tail.load(std::memory_order_acquire)) >= total;
+    };
+    if (!has_space())
+        park(m_evfd[1], r.producer_waiting, has_space);
+
+    char *d = r.data();
+    if (contiguous < need) {
+        memcpy(d + pos, &WRAP, sizeof WRAP);
+        head += contiguous;
+        pos = 0;
+    }
+    uint32_t l = (uint32_t) len;
+    memcpy(d + pos, &l, sizeof l);
+    memcpy(d + pos + REC_HDR, data, len);
+    r.head.store(head + need, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (r.consumer_waiting.load(std::memory_order_relaxed))
+        signal_evfd(m_evfd[0]);
+}
+
+size_t ShmTransport::recv_frame(void *buf, size_t cap) {
+    RingHeader &r = *m_rx;
+    const uint64_t rcap = r.capacity;
+    uint64_t tail = r.tail.load(std::memory_order_relaxed);
+    auto has_data = [&]() {
+        return r.head.load(std::memory_order_acquire) != tail;
+    };
+    char *d = r.data();
+    for (;;) {
+        if (!has_data())
+            park(m_evfd[2], r.consumer_waiting, has_data);
+        uint64_t pos = tail & (rcap - 1);
+        uint32_t l;
+        memcpy(&l, d + pos, sizeof l);
+        if (l == WRAP) {
+            tail += rcap - pos;
+            continue;
+        }
+        if (l > cap) {
+            // left in the ring, a larger buffer may retry
+            errno = EMSGSIZE;
+            err_report_and_throw("recv_frame: frame larger than buffer");
+        }
+        memcpy(buf, d + pos + REC_HDR, l);
+        r.tail.store(tail + REC_HDR + align8(l), std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (r.producer_waiting.load(std::memory_order_relaxed))
+            signal_evfd(m_evfd[3]);
+        return l;
+    }
+}
+
+}
@@ -0,0 +1,75 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_SHM_TRANSPORT_H
+#define BYLSOCKET_SHM_TRANSPORT_H
+#include "transport.h"
+#include <atomic>
+
+namespace bylSocket {
+
+/**
+ * same host transport over a pair of single-producer single-consumer
+ * lock free rings living in a memfd.
+ *
+ * the creator allocates the memfd and four eventfds (data/space for each
+ * direction) and passes them via SCM_RIGHTS over the control socket, the
+ * other end attaches to them. afterwards the control socket only serves
+ * for peer liveness: a blocked side also polls it to notice a hang-up.
+ *
+ * a side spins for a while before parking on its eventfd, and the peer
+ * only pays the eventfd write when the waiting flag is raised, so a busy
+ * pair never enters the kernel.
+ *
+ * N.B. one thread per direction at a time, the rings are SPSC.
+ */
+class ShmTransport : public Transport {
+public:
+    //! ring size in bytes for each direction, rounded up to power of 2
+    static const size_t DEFAULT_RING_BYTES = 1 << 20;
+    static const unsigned DEFAULT_SPIN = 4096;
+
+    /**
+     * set up the rings and hand them to the peer
+     * @param ctl connected unix domain socket fd, dup()ed
+     * @param ring_bytes
+     */
+    static std::unique_ptr<ShmTransport>
+    create(int ctl, size_t ring_bytes = DEFAULT_RING_BYTES);
+
+    //! map the rings offered by the creator on the other end of ctl
+    static std::unique_ptr<ShmTransport> attach(int ctl);
+
+    virtual ~ShmTransport();
+    ShmTransport(const ShmTransport &) = delete;
+    ShmTransport &operator=(const ShmTransport &) = delete;
+
+    virtual void send_frame(const void *data, size_t len) override;
+    virtual size_t recv_frame(void *buf, size_t cap) override;
+
+    //! polls of the ring before parking on the eventfd
+    void set_spin(unsigned n) { m_spin = n; }
+    //! largest frame that fits in the ring
+    size_t max_frame() const;
+
+    struct RingHeader;
+protected:
+    //! takes over ctl, the mapping and the eventfds
+    ShmTransport(int ctl, void *map, size_t map_len, const int *evfds,
+                 bool creator);
+    template<typename Ready>
+    void park(int evfd, std::atomic<uint32_t> &waiting, Ready ready);
+
+    int m_ctl;
+    size_t m_map_len;
+    void *m_map;
+    RingHeader *m_tx;
+    RingHeader *m_rx;
+    //! tx data, tx space, rx data, rx space
+    int m_evfd[4];
+    unsigned m_spin;
+};
+
+}
+#endif //BYLSOCKET_SHM_TRANSPORT_H
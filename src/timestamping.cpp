@@ -0,0 +1,136 @@
+//
+// Created on 10/19/26.
+//
+#include "timestamping.h"
+#include <ctime>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+
+namespace bylSocket {
+
+uint64_t realtime_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint64_t to_ns(const struct timespec &ts) {
+    return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+KernelTimestamps::KernelTimestamps(int fd, bool stream, bool tx)
+        : m_fd(fd), m_stream(stream), m_next_key(0), m_last_rx(0) {
+    int flags = SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_RX_SOFTWARE;
+    if (tx)
+        flags |= SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_OPT_ID
+                 | SOF_TIMESTAMPING_OPT_TSONLY;
+    if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof flags))
+        err_report_and_throw("setsockopt SO_TIMESTAMPING");
+}
+
+ssize_t KernelTimestamps::send(const void *buf, size_t len, int flags) {
+    uint64_t t = realtime_ns();
+    ssize_t n = ::send(m_fd, buf, len, flags | MSG_NOSIGNAL);
+    if (n > 0) {
+        // the key of a stream send is the offset of its last byte
+        m_next_key += m_stream ? (uint32_t) n : 1;
+        m_pending.push_back(std::make_pair(m_next_key - 1, t));
+    }
+    return n;
+}
+
+ssize_t KernelTimestamps::recv(void *buf, size_t len, int flags) {
+    struct iovec iov = {buf, len};
+    union {
+        char buf[CMSG_SPACE(sizeof(struct scm_timestamping))];
+        struct cmsghdr align;
+    } ctl;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl.buf;
+    msg.msg_controllen = sizeof ctl.buf;
+    ssize_t n = ::recvmsg(m_fd, &msg, flags);
+    if (n < 0)
+        return n;
+    uint64_t now = realtime_ns();
+    m_last_rx = 0;
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET)
+            continue;
+        struct timespec ts = {0, 0};
+        if (c->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping st;
+            memcpy(&st, CMSG_DATA(c), sizeof st);
+            ts = st.ts[0];
+        } else if (c->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(&ts, CMSG_DATA(c), sizeof ts);
+        }
+        if (ts.tv_sec || ts.tv_nsec)
+            m_last_rx = to_ns(ts);
+    }
+    if (m_last_rx && now >= m_last_rx)
+        m_rx_delay.record(now - m_last_rx);
+    return n;
+}
+
+int KernelTimestamps::collect_tx() {
+    int count = 0;
+    for (;;) {
+        char data[1];
+        struct iovec iov = {data, sizeof data};
+        union {
+            char buf[CMSG_SPACE(sizeof(struct scm_timestamping))
+                     + CMSG_SPACE(sizeof(struct sock_extended_err)
+                                  + sizeof(struct sockaddr_in6))];
+            struct cmsghdr align;
+        } ctl;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof msg);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = ctl.buf;
+        msg.msg_controllen = sizeof ctl.buf;
+        if (::recvmsg(m_fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                err_report("recvmsg MSG_ERRQUEUE");
+            return count;
+        }
+        uint64_t ts = 0;
+        bool have_key = false;
+        uint32_t key = 0;
+        for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c;
+             c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET
+                && c->cmsg_type == SCM_TIMESTAMPING) {
+                struct scm_timestamping st;
+                memcpy(&st, CMSG_DATA(c), sizeof st);
+                ts = to_ns(st.ts[0]);
+            } else if ((c->cmsg_level == SOL_IP && c->cmsg_type == IP_RECVERR)
+                       || (c->cmsg_level == SOL_IPV6
+                           && c->cmsg_type == IPV6_RECVERR)) {
+                struct sock_extended_err err;
+                memcpy(&err, CMSG_DATA(c), sizeof err);
+                if (err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING
+                    && err.ee_info == SCM_TSTAMP_SND) {
+                    key = err.ee_data;
+                    have_key = true;
+                }
+            }
+        }
+        if (!ts || !have_key)
+            continue;
+        ++count;
+        // keys wrap around at 2^32, compare by distance
+        while (!m_pending.empty()
+               && (int32_t) (m_pending.front().first - key) <= 0) {
+            std::pair<uint32_t, uint64_t> p = m_pending.front();
+            m_pending.pop_front();
+            if (p.first == key && ts >= p.second)
+                m_tx_delay.record(ts - p.second);
+        }
+    }
+}
+
+}
@@ -0,0 +1,77 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_TIMESTAMPING_H
+#define BYLSOCKET_TIMESTAMPING_H
+#include "metrics.h"
+#include <deque>
+
+namespace bylSocket {
+
+/**
+ * kernel software timestamps (SO_TIMESTAMPING) on one socket, to tell
+ * time spent in the kernel from time spent in the application:
+ *
+ *  rx_delay: packet timestamped by the kernel -> handed to recv()
+ *  tx_delay: send() called -> packet passed to the device
+ *
+ * software timestamps also work on loopback. tx timestamps are reported
+ * through the socket's error queue and need collect_tx() (poll for
+ * POLLERR), they exist for tcp/udp sockets, not for unix domain ones.
+ *
+ * N.B. the fd is not owned, all sends and receives whose delays should
+ *      be recorded must go through this object.
+ *      the kernel enables rx timestamping lazily, the first packets
+ *      after construction may arrive without (last_rx_ns() == 0).
+ */
+class KernelTimestamps {
+public:
+    /**
+     * enable SO_TIMESTAMPING on fd
+     * @param fd
+     * @param stream tx timestamp keys count bytes for stream sockets,
+     *        messages otherwise
+     * @param tx also request transmit timestamps
+     */
+    KernelTimestamps(int fd, bool stream, bool tx = true);
+    KernelTimestamps(const KernelTimestamps &) = delete;
+    KernelTimestamps &operator=(const KernelTimestamps &) = delete;
+
+    ssize_t send(const void *buf, size_t len, int flags = 0);
+    /**
+     * recv() reading the kernel receive timestamp from the cmsg
+     * (SCM_TIMESTAMPING, or SCM_TIMESTAMPNS if only SO_TIMESTAMPNS is on)
+     */
+    ssize_t recv(void *buf, size_t len, int flags = 0);
+
+    /**
+     * read the pending tx timestamps from the error queue, non-blocking
+     * @return number of timestamps consumed
+     */
+    int collect_tx();
+
+    //! kernel receive time of the last recv(), CLOCK_REALTIME ns, 0 if none
+    uint64_t last_rx_ns() const { return m_last_rx; }
+
+    const Histogram &rx_delay() const { return m_rx_delay; }
+    const Histogram &tx_delay() const { return m_tx_delay; }
+    //! sends whose tx timestamp hasn't shown up yet
+    size_t tx_pending() const { return m_pending.size(); }
+private:
+    int m_fd;
+    bool m_stream;
+    //! key of the next send: bytes or messages sent so far
+    uint32_t m_next_key;
+    uint64_t m_last_rx;
+    //! (tx key, user send time) in key order
+    std::deque<std::pair<uint32_t, uint64_t>> m_pending;
+    Histogram m_rx_delay;
+    Histogram m_tx_delay;
+};
+
+//! CLOCK_REALTIME in ns, the clock of kernel timestamps
+uint64_t realtime_ns();
+
+}
+#endif //BYLSOCKET_TIMESTAMPING_H
@@ -0,0 +1,254 @@
+//
+// Created on 10/19/26.
+//
+#include "tls.h"
+#ifdef BYLSOCKET_HAVE_OPENSSL
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <vector>
+
+namespace bylSocket {
+
+//! print and clear OpenSSL's error queue, then throw
+#define tls_fail(s) \
+    do { \
+        ERR_print_errors_fp(stderr); \
+        errno = EPROTO; \
+        err_report_and_throw(s); \
+    } while(0)
+
+TlsContext::TlsContext(Role role)
+        : m_role(role), m_verify(role == Role::CLIENT), m_ctx(nullptr) {
+    m_ctx = SSL_CTX_new(role == Role::CLIENT ? TLS_client_method()
+                                             : TLS_server_method());
+    if (!m_ctx)
+        tls_fail("SSL_CTX_new");
+    SSL_CTX_set_min_proto_version(m_ctx, TLS1_2_VERSION);
+    // a peer closing without close_notify reads as eof
+    SSL_CTX_set_options(m_ctx,
+                        SSL_OP_IGNORE_UNEXPECTED_EOF | SSL_OP_ENABLE_KTLS);
+    set_verify(m_verify);
+}
+
+TlsContext::~TlsContext() {
+    SSL_CTX_free(m_ctx);
+}
+
+void TlsContext::use_certificate(const std::string &cert_file,
+                                 const std::string &key_file) {
+    if (SSL_CTX_use_certificate_chain_file(m_ctx, cert_file.c_str()) != 1
+        || SSL_CTX_use_PrivateKey_file(m_ctx, key_file.c_str(),
+                                       SSL_FILETYPE_PEM) != 1
+        || SSL_CTX_check_private_key(m_ctx) != 1)
+        tls_fail("use_certificate");
+}
+
+void TlsContext::use_certificate_pem(const std::string &cert,
+                                     const std::string &key) {
+    BIO *cb = BIO_new_mem_buf(cert.data(), (int) cert.size());
+    BIO *kb = BIO_new_mem_buf(key.data(), (int) key.size());
+    X509 *x = cb ? PEM_read_bio_X509(cb, nullptr, nullptr, nullptr) : nullptr;
+    EVP_PKEY *k = kb ? PEM_read_bio_PrivateKey(kb, nullptr, nullptr, nullptr)
+                     : nullptr;
+    bool ok = x && k && SSL_CTX_use_certificate(m_ctx, x) == 1
+              && SSL_CTX_use_PrivateKey(m_ctx, k) == 1
+              && SSL_CTX_check_private_key(m_ctx) == 1;
+    X509_free(x);
+    EVP_PKEY_free(k);
+    BIO_free(cb);
+    BIO_free(kb);
+    if (!ok)
+        tls_fail("use_certificate_pem");
+}
+
+void TlsContext::trust(const std::string &ca_file) {
+    int r = ca_file.empty()
+            ? SSL_CTX_set_default_verify_paths(m_ctx)
+            : SSL_CTX_load_verify_locations(m_ctx, ca_file.c_str(), nullptr);
+    if (r != 1)
+        tls_fail("trust");
+}
+
+void TlsContext::trust_pem(const std::string &ca) {
+    BIO *b = BIO_new_mem_buf(ca.data(), (int) ca.size());
+    if (!b)
+        tls_fail("trust_pem");
+    X509_STORE *store = SSL_CTX_get_cert_store(m_ctx);
+    int added = 0;
+    while (X509 *x = PEM_read_bio_X509(b, nullptr, nullptr, nullptr)) {
+        if (X509_STORE_add_cert(store, x) == 1)
+            ++added;
+        X509_free(x);
+    }
+    BIO_free(b);
+    if (!added)
+        tls_fail("trust_pem: no certificate");
+    // the loop ends on a "no start line" error
+    ERR_clear_error();
+}
+
+void TlsContext::set_verify(bool verify) {
+    m_verify = verify;
+    int mode = SSL_VERIFY_NONE;
+    if (verify)
+        mode = m_role == Role::CLIENT
+               ? SSL_VERIFY_PEER
+               : SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT;
+    SSL_CTX_set_verify(m_ctx, mode, nullptr);
+}
+
+void TlsContext::set_ktls(bool ktls) {
+    if (ktls)
+        SSL_CTX_set_options(m_ctx, SSL_OP_ENABLE_KTLS);
+    else
+        SSL_CTX_clear_options(m_ctx, SSL_OP_ENABLE_KTLS);
+}
+
+bool TlsContext::available() {
+    return true;
+}
+
+TlsStream::TlsStream(TlsContext &ctx, int sock, const std::string &hostname)
+        : m_fd(dup(sock)), m_ssl(nullptr) {
+    if (m_fd == -1)
+        err_report_and_throw("dup");
+    m_ssl = SSL_new(ctx.native());
+    if (!m_ssl || SSL_set_fd(m_ssl, m_fd) != 1) {
+        SSL_free(m_ssl);
+        close(m_fd);
+        tls_fail("SSL_new");
+    }
+    int r;
+    if (ctx.role() == TlsContext::Role::CLIENT) {
+        if (!hostname.empty()) {
+            SSL_set_tlsext_host_name(m_ssl, hostname.c_str());
+            if (ctx.verify())
+                SSL_set1_host(m_ssl, hostname.c_str());
+        }
+        r = SSL_connect(m_ssl);
+    } else {
+        r = SSL_accept(m_ssl);
+    }
+    if (r != 1) {
+        SSL_free(m_ssl);
+        close(m_fd);
+        tls_fail("handshake");
+    }
+}
+
+TlsStream::~TlsStream() {
+    SSL_free(m_ssl);
+    if (close(m_fd) == -1)
+        err_report("close");
+}
+
+void TlsStream::send(const void *data, size_t len) {
+    const char *p = static_cast<const char *>(data);
+    while (len) {
+        size_t n = 0;
+        if (SSL_write_ex(m_ssl, p, len, &n) != 1)
+            tls_fail("send");
+        p += n;
+        len -= n;
+    }
+}
+
+size_t TlsStream::recv(void *buf, size_t len) {
+    size_t n = 0;
+    if (SSL_read_ex(m_ssl, buf, len, &n) == 1)
+        return n;
+    int err = SSL_get_error(m_ssl, 0);
+    if (err == SSL_ERROR_ZERO_RETURN)
+        return 0;
+    tls_fail("recv");
+}
+
+size_t TlsStream::sendfile(int file_fd, off_t offset, size_t len) {
+    size_t sent = 0;
+    if (ktls_send()) {
+        while (sent < len) {
+            ossl_ssize_t n = SSL_sendfile(m_ssl, file_fd, offset + sent,
+                                          len - sent, 0);
+            if (n <= 0)
+                tls_fail("SSL_sendfile");
+            sent += n;
+        }
+        return sent;
+    }
+    // user space: read and encrypt a record's worth at a time
+    std::vector<char> buf(16 << 10);
+    while (sent < len) {
+        ssize_t n = pread(file_fd, buf.data(), std::min(buf.size(), len - sent),
+                          offset + sent);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            err_report_and_throw("pread");
+        if (n == 0)
+            break;
+        send(buf.data(), n);
+        sent += n;
+    }
+    return sent;
+}
+
+void TlsStream::shutdown() {
+    if (SSL_shutdown(m_ssl) < 0)
+        tls_fail("shutdown");
+}
+
+bool TlsStream::ktls_send() const {
+    return BIO_get_ktls_send(SSL_get_wbio(m_ssl)) != 0;
+}
+
+bool TlsStream::ktls_recv() const {
+    return BIO_get_ktls_recv(SSL_get_rbio(m_ssl)) != 0;
+}
+
+std::string TlsStream::description() const {
+    return std::string(SSL_get_version(m_ssl)) + " "
+           + SSL_get_cipher_name(m_ssl);
+}
+
+}
+
+#else // !BYLSOCKET_HAVE_OPENSSL
+
+namespace bylSocket {
+
+#define tls_unavailable(s) \
+    do { errno = ENOTSUP; err_report_and_throw(s); } while(0)
+
+TlsContext::TlsContext(Role role)
+        : m_role(role), m_verify(false), m_ctx(nullptr) {
+    tls_unavailable("built without OpenSSL");
+}
+
+TlsContext::~TlsContext() {}
+void TlsContext::use_certificate(const std::string &, const std::string &) {}
+void TlsContext::use_certificate_pem(const std::string &,
+                                     const std::string &) {}
+void TlsContext::trust(const std::string &) {}
+void TlsContext::trust_pem(const std::string &) {}
+void TlsContext::set_verify(bool) {}
+void TlsContext::set_ktls(bool) {}
+bool TlsContext::available() { return false; }
+
+TlsStream::TlsStream(TlsContext &, int, const std::string &)
+        : m_fd(-1), m_ssl(nullptr) {
+    tls_unavailable("built without OpenSSL");
+}
+
+TlsStream::~TlsStream() {}
+void TlsStream::send(const void *, size_t) {}
+size_t TlsStream::recv(void *, size_t) { return 0; }
+size_t TlsStream::sendfile(int, off_t, size_t) { return 0; }
+void TlsStream::shutdown() {}
+bool TlsStream::ktls_send() const { return false; }
+bool TlsStream::ktls_recv() const { return false; }
+std::string TlsStream::description() const { return std::string(); }
+
+}
+
+#endif
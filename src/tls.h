@@ -0,0 +1,109 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_TLS_H
+#define BYLSOCKET_TLS_H
+#include "common.h"
+#include <string>
+
+struct ssl_ctx_st;
+struct ssl_st;
+
+namespace bylSocket {
+
+/**
+ * certificates, trust and options shared by the TlsStreams of one side.
+ *
+ * OpenSSL is optional at build time (BYLSOCKET_WITH_OPENSSL), without it
+ * available() is false and constructing a context throws ENOTSUP.
+ */
+class TlsContext {
+public:
+    enum class Role {
+        CLIENT,
+        SERVER
+    };
+
+    //! clients verify the peer by default, servers don't ask for certificates
+    explicit TlsContext(Role role);
+    TlsContext(const TlsContext &) = delete;
+    TlsContext &operator=(const TlsContext &) = delete;
+    ~TlsContext();
+
+    //! PEM files
+    void use_certificate(const std::string &cert_file, const std::string &key_file);
+    //! PEM text
+    void use_certificate_pem(const std::string &cert, const std::string &key);
+    //! trust the CA certificate(s) of a PEM file, or the system store if empty
+    void trust(const std::string &ca_file = "");
+    void trust_pem(const std::string &ca);
+    void set_verify(bool verify);
+    /**
+     * hand record encryption to the kernel after the handshake where it
+     * supports it (TCP_ULP "tls"), on by default
+     */
+    void set_ktls(bool ktls);
+
+    Role role() const { return m_role; }
+    bool verify() const { return m_verify; }
+    ssl_ctx_st *native() const { return m_ctx; }
+
+    static bool available();
+private:
+    Role m_role;
+    bool m_verify;
+    ssl_ctx_st *m_ctx;
+};
+
+/**
+ * TLS session over a connected tcp socket, handshake done by the
+ * constructor.
+ *
+ * with kTLS in effect (ktls_send()), records are encrypted by the kernel:
+ * sendfile() goes out without being copied to user space and plain
+ * writes to fd() are sent as application data too. otherwise everything
+ * goes through OpenSSL in user space, sendfile() included.
+ *
+ * N.B. the socket fd is dup()'ed and must be in blocking mode.
+ */
+class TlsStream {
+public:
+    /**
+     * @param ctx must outlive the stream
+     * @param sock connected tcp socket
+     * @param hostname for SNI and, when verifying, the name the server's
+     *  certificate must match (client side)
+     */
+    TlsStream(TlsContext &ctx, int sock, const std::string &hostname = "");
+    TlsStream(const TlsStream &) = delete;
+    TlsStream &operator=(const TlsStream &) = delete;
+    ~TlsStream();
+
+    //! send all of data
+    void send(const void *data, size_t len);
+    /**
+     * receive what's available, at least one byte
+     * @return bytes received, 0 once the peer has closed
+     */
+    size_t recv(void *buf, size_t len);
+    /**
+     * send len bytes of file_fd starting at offset
+     * @return bytes sent
+     */
+    size_t sendfile(int file_fd, off_t offset, size_t len);
+    //! send close_notify, further sends fail
+    void shutdown();
+
+    bool ktls_send() const;
+    bool ktls_recv() const;
+    //! negotiated protocol and cipher, e.g. "TLSv1.3 TLS_AES_128_GCM_SHA256"
+    std::string description() const;
+    int fd() const { return m_fd; }
+private:
+    int m_fd;
+    ssl_st *m_ssl;
+};
+
+}
+#endif //BYLSOCKET_TLS_H
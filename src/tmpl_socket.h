@@ -5,6 +5,7 @@
 #ifndef BYLSOCKET_TMPL_SOCKET_H
 #define BYLSOCKET_TMPL_SOCKET_H
 #include "common.h"
+#include "format.h"
 
 namespace bylSocket {
 namespace Tmpl {
@@ -53,17 +54,41 @@ public:
     Socket();
     void bind(const char *local, const char *port = "\0");
     void connect(const char *remote, const char *port = "\0");
+    //! @param backlog BACKLOG_SOMAXCONN for the kernel's maximum
     void listen(int backlog);
     Socket accept();
+    /**
+     * @param o
+     * @param sec seconds of RCVTIMEO/SNDTIMEO, or the value of a valued
+     *        option, e.g. usecs of BUSY_POLL
+     * @param nsec
+     */
     void set_opt(Options o, time_t sec = 0, long int nsec = 0);
 
+    /**
+     * pass fds to the peer as SCM_RIGHTS ancillary data,
+     * only for Domain::UNIX. see bylSocket::send_fds
+     * @param msg payload carrying the fds, sent with its '\0'
+     */
+    void send_fds(const int *fds, int nfds, const char *msg = "");
+    /**
+     * receive fds passed by send_fds, only for Domain::UNIX.
+     * the received fds can be adopted by Socket(fd, Status::CONNECTED)
+     * @param msg buffer for the payload, must hold what the peer sent
+     * @return number of fds received
+     */
+    int recv_fds(int *fds, int max_fds, char *msg = nullptr, int msg_len = 0);
+
+    //! adopt an already opened fd, e.g. one received by recv_fds
+    Socket(int fd, Status ss);
+    int fd() const { return *m_pfd; }
+
     Socket(const Socket &) = default;
     Socket(Socket &&) = default;
     Socket &operator=(const Socket &) = default;
     Socket &operator=(Socket &&) = default;
     virtual ~Socket() {}
 protected:
-    Socket(int fd, Status ss);
     std::shared_ptr<int> m_pfd;
     Status m_status;
 };
@@ -74,14 +99,18 @@ public:
     BufferedSocket() : Socket<D, T>() {}
     BufferedSocket(const Socket<D, T> &o) : Socket<D, T>(o) {}
     BufferedSocket(Socket<D, T> &&o) : Socket<D, T>(std::move(o)) {}
-    BufferedSocket(const BufferedSocket &o) : Socket<D, T>(o) {}
-    BufferedSocket(BufferedSocket &&o) : Socket<D, T>(std::move(o)) {}
+    BufferedSocket(const BufferedSocket &o)
+            : Socket<D, T>(o), m_fmt_nul(o.m_fmt_nul) {}
+    BufferedSocket(BufferedSocket &&o)
+            : Socket<D, T>(std::move(o)), m_fmt_nul(o.m_fmt_nul) {}
     BufferedSocket &operator=(const BufferedSocket &o) {
         Socket<D, T>::operator=(o);
+        m_fmt_nul = o.m_fmt_nul;
         return *this;
     }
     BufferedSocket &operator=(BufferedSocket &&o) {
         Socket<D, T>::operator=(std::move(o));
+        m_fmt_nul = o.m_fmt_nul;
         return *this;
     }
 
@@ -91,9 +120,29 @@ public:
     void send(const char *str);
     const char *recv(int n = BUFSZ - 1);
 
+    /**
+     * format by bylSocket::format_to into a growable buffer and send it,
+     * nothing gets truncated. the trailing '\0' fsend always adds is
+     * only sent if fmt_nul is enabled (default).
+     */
+    template<typename ... Args>
+    void send_fmt(const char *format, const Args &... args) {
+        m_wbuf.clear();
+        format_to(m_wbuf, format, args...);
+        if (m_fmt_nul)
+            m_wbuf.push_back('\0');
+        send_wbuf();
+    }
+    void set_fmt_nul(bool on) { m_fmt_nul = on; }
+
 protected:
+    void send_wbuf();
+
     static const int BUFSZ = 512;
+    static const size_t WBUF_KEEP = 64 << 10;
     char m_buff[BUFSZ];
+    std::string m_wbuf;
+    bool m_fmt_nul = true;
 };
 
 template<Domain D>
@@ -104,7 +153,7 @@ class ListenedSocket<Domain::IP4> : public Socket<Domain::IP4, Type::STREAM> {
 public:
     explicit ListenedSocket(const char *port = "50000",
                             const char *local = "127.0.0.1",
-                            int backlog = 50);
+                            int backlog = BACKLOG_SOMAXCONN);
 
 };
 template<>
@@ -112,14 +161,18 @@ class ListenedSocket<Domain::IP6> : public Socket<Domain::IP6, Type::STREAM> {
 public:
     explicit ListenedSocket(const char *port = "50000",
                             const char *local = "::1",
-                            int backlog = 50);
+                            int backlog = BACKLOG_SOMAXCONN);
 };
 template<>
 class ListenedSocket<Domain::UNIX> : public Socket<Domain::UNIX, Type::STREAM> {
 public:
-    explicit ListenedSocket(const char *local, int backlog = 50);
+    explicit ListenedSocket(const char *local, int backlog = BACKLOG_SOMAXCONN);
 };
 
 }
 }
+
+#ifdef BYLSOCKET_HEADER_ONLY
+#include "tmpl_socket_impl.h"
+#endif
 #endif //BYLSOCKET_TMPL_SOCKET_H
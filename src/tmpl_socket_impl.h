@@ -0,0 +1,269 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_TMPL_SOCKET_IMPL_H
+#define BYLSOCKET_TMPL_SOCKET_IMPL_H
+/**
+ * definitions of the Tmpl::Socket and Tmpl::BufferedSocket templates.
+ *
+ * compiled into the library and explicitly instantiated there by
+ * tmpl_socket.cpp. defining BYLSOCKET_HEADER_ONLY before including
+ * tmpl_socket.h pulls them into the including translation unit instead,
+ * so the calls can be inlined and the domain/type checks folded away.
+ * the non template parts (ListenedSocket, fd passing, write_full) still
+ * come from libbylsocket.
+ */
+#include "tmpl_socket.h"
+#include "fd_passing.h"
+#include "transport.h"
+
+namespace bylSocket {
+namespace Tmpl {
+
+namespace detail {
+
+inline void deleter(int *pf) {
+    assert(pf && "deleter");
+    if (close(*pf) == -1)
+        err_report("close");
+    delete pf;
+}
+
+} // namespace detail
+
+template<Domain s_d, Type s_t>
+Socket<s_d, s_t>
+::Socket() : Socket(-1, Status::UNINITIALIZED) {
+    *m_pfd = ::socket(static_cast<int>(s_d), static_cast<int>(s_t), 0);
+    if (*m_pfd == -1) {
+        err_report_and_throw("socket");
+    }
+    m_status = Status::FREE;
+}
+
+template<Domain d>
+void set_sockaddr(const char *addr,
+                  const char *port,
+                  struct sockaddr_storage &ret_addr,
+                  socklen_t &len);
+
+template<>
+inline void set_sockaddr<Domain::UNIX>(const char *addr,
+                                       const char *port,
+                                       struct sockaddr_storage &ret_addr,
+                                       socklen_t &len) {
+    (void) port;
+    struct sockaddr_un *p = (struct sockaddr_un *) &ret_addr;
+    memset(p, 0, sizeof *p); // leading '\0' makes the name abstract
+    p->sun_family = AF_UNIX;
+    len = sizeof(p->sun_family) + 1
+          + std::min(sizeof(p->sun_path) - 2, strlen(addr));
+    strncpy(p->sun_path + 1, addr, sizeof(p->sun_path) - 2);
+}
+
+template<>
+inline void set_sockaddr<Domain::IP4>(const char *addr,
+                                      const char *port,
+                                      struct sockaddr_storage &ret_addr,
+                                      socklen_t &len) {
+
+    struct sockaddr_in *p = (struct sockaddr_in *) &ret_addr;
+    len = sizeof *p;
+    p->sin_family = AF_INET;
+    assert(port);
+    p->sin_port = htons((uint16_t) atoi(port));
+    if (inet_pton(AF_INET, addr, &(p->sin_addr)) <= 0)
+        err_report_and_throw("inet_pton");
+}
+
+template<>
+inline void set_sockaddr<Domain::IP6>(const char *addr,
+                                      const char *port,
+                                      struct sockaddr_storage &ret_addr,
+                                      socklen_t &len) {
+
+    struct sockaddr_in6 *p = (struct sockaddr_in6 *) &ret_addr;
+    len = sizeof *p;
+    p->sin6_family = AF_INET6;
+    assert(port);
+    p->sin6_port = htons((uint16_t) atoi(port));
+    if (inet_pton(AF_INET6, addr, &(p->sin6_addr)) <= 0)
+        err_report_and_throw("inet_pton");
+}
+
+template<Domain s_d, Type s_t>
+void Socket<s_d, s_t>
+::bind(const char *local,
+       const char *port) {
+    assert_n_throw(m_status == Status::FREE);
+
+    socklen_t slen;
+    struct sockaddr_storage addr;
+    set_sockaddr<s_d>(local, port, addr, slen);
+    if (::bind(*m_pfd, (sockaddr *) &addr, slen))
+        err_report_and_throw("bind");
+    m_status = Status::BINDED;
+}
+
+template<Domain s_d, Type s_t>
+void Socket<s_d, s_t>
+::connect(const char *remote,
+          const char *port) {
+    assert_n_throw(m_status == Status::FREE || m_status == Status::BINDED);
+
+    socklen_t slen;
+    struct sockaddr_storage addr;
+    set_sockaddr<s_d>(remote, port, addr, slen);
+    if (::connect(*m_pfd, (sockaddr *) &addr, slen))
+        err_report_and_throw("connect");
+    m_status = Status::CONNECTED;
+}
+
+template<Domain s_d, Type s_t>
+void Socket<s_d, s_t>
+::listen(int backlog) {
+    assert_n_throw(m_status == Status::BINDED
+                   && (s_t == Type::STREAM || s_t == Type::SEQPACKET));
+    if (backlog == BACKLOG_SOMAXCONN)
+        backlog = somaxconn();
+    if (::listen(*m_pfd, backlog) == -1)
+        err_report_and_throw("listen");
+    m_status = Status::LISTENING;
+}
+
+template<Domain s_d, Type s_t>
+Socket<s_d, s_t> Socket<s_d, s_t>
+::accept() {
+    assert_n_throw(m_status == Status::LISTENING
+                   && (s_t == Type::STREAM || s_t == Type::SEQPACKET));
+    int fd = ::accept(*m_pfd, NULL, NULL);
+    if (fd == -1)
+        err_report_and_throw("accept");
+    return Socket(fd, Status::CONNECTED);
+}
+
+template<Domain s_d, Type s_t>
+Socket<s_d, s_t>
+::Socket(int fd, Status ss) :
+        m_pfd(new int(fd), detail::deleter),
+        m_status(ss) {}
+
+template<Domain s_d, Type s_t>
+void Socket<s_d, s_t>::set_opt(Options o,
+                               time_t sec,
+                               long nsec) {
+    if (s_t != Type::STREAM && o == Options::KEEPALIVE) {
+        err_report("KEEPALIVE only for connection based socket!");
+        return;
+    }
+    if (s_t != Type::DGRAM && o == Options::DGRAM_BROADCAST) {
+        err_report("DGRAM_BROADCAST only for DGRAM based socket!");
+        return;
+    }
+    if ((o == Options::REUSEADDR || o == Options::REUSEPORT)
+        && m_status != Status::FREE) {
+        err_report("Options::REUSEADDR or Options::REUSEPORT "
+                           "Must set before bound");
+        return;
+    }
+    /**
+     * TODO optval must not be type bool
+     *      otherwise throwing invalid argument error
+     */
+    int optval = true;
+    if (o == Options::BUSY_POLL || o == Options::TIMESTAMPING)
+        optval = (int) sec;
+    void *p = &optval;
+    socklen_t len = sizeof optval;
+    // 64 bit, rates above 4GB/s don't fit an int
+    uint64_t rate = (uint64_t) sec;
+    if (o == Options::MAX_PACING_RATE) {
+        p = &rate;
+        len = sizeof rate;
+    }
+    struct timeval t = {sec, nsec};
+    if (o == Options::RCVTIMEO || o == Options::SNDTIMEO) {
+        p = &t;
+        len = sizeof t;
+    }
+    if (setsockopt(*m_pfd, SOL_SOCKET,
+                   static_cast<int>(o), p, len) == -1)
+        err_report_and_throw("setsockopt");
+}
+
+template<Domain s_d, Type s_t>
+void Socket<s_d, s_t>::send_fds(const int *fds, int nfds, const char *msg) {
+    assert_n_throw(s_d == Domain::UNIX && m_status == Status::CONNECTED);
+    bylSocket::send_fds(*m_pfd, fds, nfds, msg, strlen(msg) + 1);
+}
+
+template<Domain s_d, Type s_t>
+int Socket<s_d, s_t>::recv_fds(int *fds, int max_fds, char *msg, int msg_len) {
+    assert_n_throw(s_d == Domain::UNIX && m_status == Status::CONNECTED);
+    assert_n_throw(msg_len >= 0);
+    return bylSocket::recv_fds(*m_pfd, fds, max_fds, msg, (size_t) msg_len);
+}
+
+template<Domain D, Type T>
+void BufferedSocket<D, T>::fsend(const char *format, ...) {
+    va_list argptr;
+    va_start(argptr, format);
+    int len = vsnprintf(m_buff, BUFSZ, format, argptr);
+    va_end(argptr);
+    if (len < 0) {
+        err_report("vsnprintf");
+        return;
+    }
+
+    if (len >= BUFSZ) {
+        /** according to the mannual **/
+        err_report("fsend truncated.");
+        len = BUFSZ - 1;
+    }
+
+    m_buff[len] = '\0';
+    if (::send(*this->m_pfd, m_buff, len + 1, 0) <= 0) {
+        err_report_and_throw("send");
+    }
+}
+template<Domain D, Type T>
+void BufferedSocket<D, T>::send(const char *str) {
+    int len = std::min((size_t) (BUFSZ), strlen(str));
+    memcpy(m_buff, str, len);
+    if (len >= BUFSZ) {
+        err_report("send truncated.");
+        len = BUFSZ - 1;
+    }
+    m_buff[len] = '\0';
+    if (::send(*this->m_pfd, m_buff, len + 1, 0) <= 0) {
+        err_report_and_throw("send");
+    }
+}
+template<Domain D, Type T>
+void BufferedSocket<D, T>::send_wbuf() {
+    write_full(*this->m_pfd, m_wbuf.data(), m_wbuf.size());
+    // don't let one huge reply pin its buffer for the connection's life
+    if (m_wbuf.capacity() > WBUF_KEEP)
+        std::string().swap(m_wbuf);
+}
+
+template<Domain D, Type T>
+const char *BufferedSocket<D, T>::recv(int n) {
+    assert_n_throw(this->m_status == Status::BINDED
+                   || this->m_status == Status::CONNECTED);
+    if (n < 0 || n > BUFSZ - 1) {
+        err_report("n: out of range");
+        return m_buff;
+    }
+    int len = ::recv(*this->m_pfd, m_buff, n, 0);
+    if (len <= 0) {
+        err_report_and_throw("recv");
+    }
+    m_buff[len] = '\0';
+    return m_buff;
+}
+
+}
+}
+#endif //BYLSOCKET_TMPL_SOCKET_IMPL_H
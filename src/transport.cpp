@@ -0,0 +1,123 @@
+//
+// Created on 10/19/26.
+//
+#include "transport.h"
+#include "shm_transport.h"
+#include "compression.h"
+#include <sys/uio.h>
+
+namespace bylSocket {
+
+void write_full(int fd, const void *data, size_t len) {
+    const char *p = static_cast<const char *>(data);
+    while (len) {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            err_report_and_throw("send");
+        p += n;
+        len -= n;
+    }
+}
+
+void read_full(int fd, void *data, size_t len) {
+    char *p = static_cast<char *>(data);
+    while (len) {
+        ssize_t n = ::recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n == 0) {
+            errno = ECONNRESET;
+            err_report_and_throw("recv: peer closed");
+        }
+        if (n < 0)
+            err_report_and_throw("recv");
+        p += n;
+        len -= n;
+    }
+}
+
+SocketTransport::SocketTransport(int sock) : m_fd(dup(sock)) {
+    if (m_fd == -1)
+        err_report_and_throw("dup");
+}
+
+SocketTransport::~SocketTransport() {
+    if (close(m_fd) == -1)
+        err_report("close");
+}
+
+void SocketTransport::send_frame(const void *data, size_t len) {
+    send_parts(nullptr, 0, data, len);
+}
+
+void SocketTransport::send_parts(const void *hdr, size_t hlen,
+                                 const void *data, size_t len) {
+    assert_n_throw(hlen + len <= UINT32_MAX);
+    uint32_t prefix = htonl((uint32_t) (hlen + len));
+    struct iovec iov[3] = {{&prefix, sizeof prefix},
+                           {const_cast<void *>(hdr), hlen},
+                           {const_cast<void *>(data), len}};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 3;
+    size_t left = sizeof prefix + hlen + len;
+    // one syscall for header and payload in the common case
+    while (left) {
+        ssize_t n = ::sendmsg(m_fd, &msg, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            err_report_and_throw("sendmsg");
+        left -= n;
+        while (n && msg.msg_iovlen) {
+            size_t k = std::min((size_t) n, msg.msg_iov->iov_len);
+            msg.msg_iov->iov_base = (char *) msg.msg_iov->iov_base + k;
+            msg.msg_iov->iov_len -= k;
+            n -= k;
+            if (!msg.msg_iov->iov_len) {
+                ++msg.msg_iov;
+                --msg.msg_iovlen;
+            }
+        }
+    }
+}
+
+size_t SocketTransport::recv_frame(void *buf, size_t cap) {
+    uint32_t hdr;
+    read_full(m_fd, &hdr, sizeof hdr);
+    size_t len = ntohl(hdr);
+    if (len > cap) {
+        skip(len);
+        errno = EMSGSIZE;
+        err_report_and_throw("recv_frame: frame larger than buffer");
+    }
+    read_full(m_fd, buf, len);
+    return len;
+}
+
+void SocketTransport::skip(size_t len) {
+    char buf[4096];
+    while (len) {
+        size_t n = std::min(len, sizeof buf);
+        read_full(m_fd, buf, n);
+        len -= n;
+    }
+}
+
+std::unique_ptr<Transport> make_transport(TransportKind kind,
+                                          int sock,
+                                          bool creator) {
+    if (kind == TransportKind::SHM) {
+        if (creator)
+            return std::unique_ptr<Transport>(ShmTransport::create(sock));
+        return std::unique_ptr<Transport>(ShmTransport::attach(sock));
+    }
+    if (kind == TransportKind::COMPRESSED)
+        return std::unique_ptr<Transport>(new CompressedTransport(sock));
+    return std::unique_ptr<Transport>(new SocketTransport(sock));
+}
+
+}
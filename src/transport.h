@@ -0,0 +1,86 @@
+//
+// Created on 10/19/26.
+//
+
+#ifndef BYLSOCKET_TRANSPORT_H
+#define BYLSOCKET_TRANSPORT_H
+#include "common.h"
+
+namespace bylSocket {
+
+enum class TransportKind {
+    SOCKET, //!< length prefixed frames over the stream socket itself
+    SHM,    //!< shared memory rings, the socket is only the control channel
+    COMPRESSED //!< like SOCKET, frames compressed with the best common codec
+};
+
+/**
+ * framed, message oriented point-to-point channel.
+ *
+ * every implementation owns a dup() of the socket fd it's built upon,
+ * so the originating Socket may go away independently.
+ */
+class Transport {
+public:
+    virtual ~Transport() {}
+
+    /**
+     * send one frame, block until it's been queued
+     * @param data
+     * @param len
+     */
+    virtual void send_frame(const void *data, size_t len) = 0;
+
+    /**
+     * receive one frame, block until available.
+     * throws if the frame is larger than cap or the peer has gone.
+     * @param buf
+     * @param cap
+     * @return frame length
+     */
+    virtual size_t recv_frame(void *buf, size_t cap) = 0;
+};
+
+/**
+ * frames as 4 bytes big endian length + payload over a connected
+ * stream socket. a frame larger than recv_frame's cap is skipped before
+ * it throws, the next call gets the next frame.
+ */
+class SocketTransport : public Transport {
+public:
+    explicit SocketTransport(int sock);
+    virtual ~SocketTransport();
+
+    SocketTransport(const SocketTransport &) = delete;
+    SocketTransport &operator=(const SocketTransport &) = delete;
+
+    virtual void send_frame(const void *data, size_t len) override;
+    virtual size_t recv_frame(void *buf, size_t cap) override;
+protected:
+    //! one frame made of hdr followed by data
+    void send_parts(const void *hdr, size_t hlen, const void *data, size_t len);
+    //! read and drop len bytes, the rest of a frame not received
+    void skip(size_t len);
+
+    int m_fd;
+};
+
+/**
+ * build the transport chosen by configuration upon a connected
+ * stream socket (unix domain for TransportKind::SHM).
+ * @param kind
+ * @param sock connected socket fd, not taken over
+ * @param creator exactly one of both ends must be the creator, which
+ *        sets up the shared memory for TransportKind::SHM
+ * @return
+ */
+std::unique_ptr<Transport> make_transport(TransportKind kind,
+                                          int sock,
+                                          bool creator);
+
+//! write/read exactly len bytes, throw on error or eof
+void write_full(int fd, const void *data, size_t len);
+void read_full(int fd, void *data, size_t len);
+
+}
+#endif //BYLSOCKET_TRANSPORT_H
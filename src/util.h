@@ -11,11 +11,21 @@
 #include <thread>
 #include <cstdio>
 #include <cstring>
+#include <cstdarg>
 #include <unistd.h>
 #include <assert.h>
 
 namespace bylSocket {
 
+//! hint the cpu inside spin-wait loops
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
 #define err_report_and_throw(s) \
     do { fprintf(stderr, "%s: %s (%s) in %s at line %d\n", __func__, s, \
             strerror(errno), __FILE__, __LINE__);\
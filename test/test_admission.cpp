@@ -0,0 +1,165 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+#include "../src/admission.h"
+#include <vector>
+#include <sys/resource.h>
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+typedef Socket<Domain::IP4, Type::STREAM> Tcp;
+
+TEST(admission, somaxconn_backlog) {
+    int n = somaxconn();
+    EXPECT_GT(n, 0);
+    FILE *f = fopen("/proc/sys/net/core/somaxconn", "r");
+    if (f) {
+        int sys = 0;
+        ASSERT_EQ(1, fscanf(f, "%d", &sys));
+        fclose(f);
+        EXPECT_EQ(sys, n);
+    }
+    // the default backlog is the kernel's maximum
+    ListenedSocket<Domain::IP4> srv("50210");
+    std::vector<Tcp> clients(200);
+    for (auto &c : clients)
+        c.connect("127.0.0.1", "50210");
+    EventLoop loop;
+    AdmissionOptions o;
+    o.max_connections = 0;
+    AdmissionControl ac(loop, srv, [](int fd) { close(fd); }, o);
+    EXPECT_EQ(200, ac.pending());
+}
+
+TEST(admission, pause_at_max_connections) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_admission");
+    EventLoop loop;
+    std::vector<int> fds;
+    AdmissionOptions o;
+    o.max_connections = 2;
+    AdmissionControl ac(loop, srv, [&](int fd) { fds.push_back(fd); }, o);
+
+    std::vector<Socket<Domain::UNIX, Type::STREAM>> clients(4);
+    for (auto &c : clients)
+        c.connect("bylsocket_test_admission");
+    for (int i = 0; i < 5; ++i)
+        loop.run_once(10);
+    EXPECT_EQ(2u, fds.size());
+    EXPECT_TRUE(ac.paused());
+    EXPECT_EQ(1u, ac.stats().pauses);
+
+    close(fds[0]);
+    ac.closed();
+    EXPECT_FALSE(ac.paused());
+    for (int i = 0; i < 5; ++i)
+        loop.run_once(10);
+    EXPECT_EQ(3u, fds.size());
+    EXPECT_EQ(2u, ac.connections());
+    EXPECT_EQ(0u, ac.stats().shed);
+    for (size_t i = 1; i < fds.size(); ++i)
+        close(fds[i]);
+}
+
+TEST(admission, reset_when_busy) {
+    ListenedSocket<Domain::IP4> srv("50211");
+    EventLoop loop;
+    std::vector<int> fds;
+    AdmissionOptions o;
+    o.max_in_flight = 1;
+    o.shed = AdmissionOptions::Shed::RESET;
+    AdmissionControl ac(loop, srv, [&](int fd) { fds.push_back(fd); }, o);
+
+    Tcp first;
+    first.connect("127.0.0.1", "50211");
+    loop.run_once(100);
+    ASSERT_EQ(1u, fds.size());
+
+    ac.work_begin();
+    Tcp second;
+    second.connect("127.0.0.1", "50211");
+    loop.run_once(100);
+    EXPECT_EQ(1u, fds.size());
+    EXPECT_EQ(1u, ac.stats().shed);
+    EXPECT_FALSE(ac.paused());
+    char c;
+    EXPECT_EQ(-1, ::recv(second.fd(), &c, 1, 0));
+    EXPECT_EQ(ECONNRESET, errno);
+
+    ac.work_end();
+    Tcp third;
+    third.connect("127.0.0.1", "50211");
+    loop.run_once(100);
+    EXPECT_EQ(2u, fds.size());
+    EXPECT_EQ(2u, ac.stats().accepted);
+    for (int fd : fds)
+        close(fd);
+}
+
+TEST(admission, pause_over_memory) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_admission_mem");
+    EventLoop loop;
+    MemoryBudget budget;
+    int accepted = 0;
+    AdmissionOptions o;
+    o.budget = &budget;
+    o.memory_high = 1000;
+    AdmissionControl ac(loop, srv, [&](int fd) {
+        ++accepted;
+        close(fd);
+    }, o);
+
+    ASSERT_TRUE(budget.try_acquire(2000));
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect("bylsocket_test_admission_mem");
+    loop.run_once(10);
+    EXPECT_TRUE(ac.paused());
+    EXPECT_EQ(0, accepted);
+    loop.run_once(10);
+
+    budget.release(2000);
+    ac.update();
+    loop.run_once(10);
+    EXPECT_EQ(1, accepted);
+}
+
+TEST(admission, out_of_fds_retries) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_admission_fds");
+    EventLoop loop;
+    std::vector<int> fds;
+    AdmissionOptions o;
+    o.fd_retry_ms = 20;
+    AdmissionControl ac(loop, srv, [&](int fd) { fds.push_back(fd); }, o);
+    std::vector<Socket<Domain::UNIX, Type::STREAM>> clients(2);
+    for (auto &c : clients)
+        c.connect("bylsocket_test_admission_fds");
+
+    // use up the fds below a lowered limit
+    struct rlimit saved;
+    ASSERT_EQ(0, getrlimit(RLIMIT_NOFILE, &saved));
+    struct rlimit low = saved;
+    low.rlim_cur = 256;
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &low));
+    std::vector<int> filler;
+    int fd;
+    while ((fd = dup(0)) != -1)
+        filler.push_back(fd);
+    loop.run_once(10);
+    EXPECT_TRUE(ac.paused());
+    EXPECT_EQ(1u, ac.stats().fd_pauses);
+    EXPECT_EQ(0u, ac.stats().pauses);
+    EXPECT_TRUE(fds.empty());
+
+    // freed behind its back, the timer resumes accepting
+    for (int f : filler)
+        close(f);
+    ASSERT_EQ(0, setrlimit(RLIMIT_NOFILE, &saved));
+    for (int i = 0; i < 10 && fds.size() < 2; ++i)
+        loop.run_once(10);
+    EXPECT_FALSE(ac.paused());
+    EXPECT_EQ(2u, fds.size());
+    for (int f : fds)
+        close(f);
+}
@@ -0,0 +1,158 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/broadcaster.h"
+#include <sys/socket.h>
+using namespace bylSocket;
+
+namespace {
+struct Pair {
+    Pair() {
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) == -1)
+            err_report_and_throw("socketpair");
+    }
+    ~Pair() {
+        for (int fd : sv)
+            if (fd != -1)
+                close(fd);
+    }
+    //! non-blocking read of what's there
+    std::string drain() {
+        std::string s;
+        char buf[4096];
+        ssize_t n;
+        while ((n = ::recv(sv[1], buf, sizeof buf, MSG_DONTWAIT)) > 0)
+            s.append(buf, n);
+        return s;
+    }
+    int sv[2];
+};
+}
+
+TEST(broadcaster, fan_out) {
+    EventLoop loop;
+    MemoryBudget budget;
+    Pair p[4];
+    Broadcaster b(loop, Broadcaster::SlowPolicy::DROP, 1 << 20, &budget);
+    for (auto &x : p)
+        b.subscribe(x.sv[0]);
+    EXPECT_EQ(4u, b.subscribers());
+
+    EXPECT_EQ(4u, b.publish("hello ", 6));
+    EXPECT_EQ(4u, b.publish_fmt("{} {}", "world", 42));
+    for (auto &x : p)
+        EXPECT_EQ("hello world 42", x.drain());
+    // written straight away, nothing held
+    EXPECT_EQ(0u, b.held_bytes());
+    EXPECT_EQ(0u, budget.used());
+    EXPECT_EQ(8u, b.stats().delivered);
+}
+
+TEST(broadcaster, shared_memory_and_drop) {
+    EventLoop loop;
+    MemoryBudget budget;
+    const size_t backlog = 1 << 20;
+    Pair p[8];
+    Broadcaster b(loop, Broadcaster::SlowPolicy::DROP, backlog, &budget);
+    for (auto &x : p)
+        b.subscribe(x.sv[0]);
+
+    // nobody reads, the kernel buffers fill and the queues grow
+    std::string msg(64 << 10, 'm');
+    int n = 0;
+    while (b.stats().dropped == 0) {
+        b.publish(msg.data(), msg.size());
+        ++n;
+        // every queue holds the same messages, the budget pays for them once
+        ASSERT_EQ(b.held_bytes(), budget.used());
+        ASSERT_LE(budget.used(), backlog + msg.size());
+    }
+    EXPECT_EQ(8u, b.stats().dropped);
+    EXPECT_EQ(8u, b.subscribers());
+    EXPECT_GT(b.backlog(p[0].sv[0]), 0u);
+
+    // drain everyone, all receive the same whole messages
+    size_t got[8] = {};
+    for (int round = 0; round < 10000 && b.held_bytes(); ++round) {
+        loop.run_once(100);
+        for (int i = 0; i < 8; ++i)
+            got[i] += p[i].drain().size();
+    }
+    EXPECT_EQ(0u, b.held_bytes());
+    EXPECT_EQ(0u, budget.used());
+    for (int i = 0; i < 8; ++i) {
+        got[i] += p[i].drain().size();
+        EXPECT_EQ(0u, got[i] % msg.size());
+        EXPECT_EQ(got[0], got[i]);
+    }
+    EXPECT_EQ((size_t) (n - 1) * msg.size(), got[0]);
+}
+
+TEST(broadcaster, slow_subscriber_disconnected) {
+    EventLoop loop;
+    MemoryBudget budget;
+    Pair fast, slow;
+    Broadcaster b(loop, Broadcaster::SlowPolicy::DISCONNECT, 256 << 10, &budget);
+    std::vector<int> gone;
+    b.subscribe(fast.sv[0], [&](int fd) { gone.push_back(fd); });
+    b.subscribe(slow.sv[0], [&](int fd) { gone.push_back(fd); });
+
+    std::string msg(16 << 10, 's');
+    size_t got = 0;
+    while (gone.empty()) {
+        b.publish(msg.data(), msg.size());
+        loop.run_once(0);
+        got += fast.drain().size();
+    }
+    ASSERT_EQ(1u, gone.size());
+    EXPECT_EQ(slow.sv[0], gone[0]);
+    EXPECT_EQ(1u, b.subscribers());
+    EXPECT_EQ(1u, b.stats().disconnected);
+
+    EXPECT_EQ(1u, b.publish(msg.data(), msg.size()));
+    for (int round = 0; round < 1000 && b.held_bytes(); ++round) {
+        loop.run_once(100);
+        got += fast.drain().size();
+    }
+    got += fast.drain().size();
+    EXPECT_EQ((b.stats().published) * msg.size(), got);
+    EXPECT_EQ(0u, budget.used());
+}
+
+TEST(broadcaster, large_message_to_idle_subscribers) {
+    EventLoop loop;
+    MemoryBudget budget;
+    Pair p[2];
+    Broadcaster b(loop, Broadcaster::SlowPolicy::DISCONNECT, 4 << 10, &budget);
+    for (auto &x : p)
+        b.subscribe(x.sv[0]);
+
+    // larger than max_backlog, but nobody has a backlog yet
+    std::string msg(64 << 10, 'l');
+    EXPECT_EQ(2u, b.publish(msg.data(), msg.size()));
+    EXPECT_EQ(2u, b.subscribers());
+    EXPECT_EQ(0u, b.stats().disconnected);
+    size_t got[2] = {};
+    for (int round = 0; round < 1000 && b.held_bytes(); ++round) {
+        loop.run_once(100);
+        for (int i = 0; i < 2; ++i)
+            got[i] += p[i].drain().size();
+    }
+    for (int i = 0; i < 2; ++i)
+        EXPECT_EQ(msg.size(), got[i] + p[i].drain().size());
+}
+
+TEST(broadcaster, hangup_unsubscribes) {
+    EventLoop loop;
+    Pair p;
+    Broadcaster b(loop);
+    int gone = -1;
+    b.subscribe(p.sv[0], [&](int fd) { gone = fd; });
+    close(p.sv[1]);
+    p.sv[1] = -1;
+    for (int round = 0; round < 10 && gone == -1; ++round)
+        loop.run_once(100);
+    EXPECT_EQ(p.sv[0], gone);
+    EXPECT_EQ(0u, b.subscribers());
+}
@@ -0,0 +1,75 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+#include "../src/busy_poll.h"
+#include "../src/metrics.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+TEST(busypoll, spin_then_park) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_busy_poll");
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect("bylsocket_test_busy_poll");
+    auto conn = srv.accept();
+
+    BusyPoller bp(20000);
+    char buf[8];
+    ASSERT_EQ(2, ::send(cli.fd(), "hi", 2, 0));
+    EXPECT_EQ(2, bp.recv(conn.fd(), buf, sizeof buf));
+    EXPECT_EQ(1u, bp.stats().spin_hits);
+
+    EXPECT_EQ(-1, bp.recv(conn.fd(), buf, sizeof buf, 10));
+    EXPECT_EQ(EAGAIN, errno);
+    EXPECT_EQ(1u, bp.stats().parks);
+    EXPECT_GT(bp.stats().empty_polls, 0u);
+    // a spin in vain shrinks the budget
+    EXPECT_EQ(10000u, bp.spin_budget_ns());
+
+    std::thread late([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ::send(cli.fd(), "x", 1, 0);
+    });
+    EXPECT_EQ(1, bp.recv(conn.fd(), buf, sizeof buf));
+    late.join();
+}
+
+TEST(busypoll, timeout_includes_spin) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    // a spin budget far beyond the timeout
+    BusyPoller bp(200 * 1000000ull, false);
+    char buf[8];
+    uint64_t t0 = now_ns();
+    EXPECT_EQ(-1, bp.recv(sv[0], buf, sizeof buf, 20));
+    EXPECT_EQ(EAGAIN, errno);
+    double ms = (now_ns() - t0) / 1e6;
+    EXPECT_GE(ms, 20);
+    EXPECT_LT(ms, 150);
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(busypoll, errors_are_no_hits) {
+    BusyPoller bp(10000);
+    char buf[16];
+    EXPECT_EQ(-1, bp.recv(-1, buf, sizeof buf));
+    EXPECT_EQ(EBADF, errno);
+    EXPECT_EQ(0u, bp.stats().spin_hits);
+}
+
+TEST(busypoll, pin_thread) {
+    // any cpu the process may run on, not necessarily cpu 0
+    cpu_set_t allowed;
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof allowed, &allowed));
+    int cpu = 0;
+    while (!CPU_ISSET(cpu, &allowed))
+        ++cpu;
+    std::thread t([cpu]() {
+        pin_thread(cpu);
+        EXPECT_EQ(cpu, current_cpu());
+    });
+    t.join();
+}
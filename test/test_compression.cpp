@@ -0,0 +1,106 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/compression.h"
+#include <thread>
+#include <vector>
+using namespace bylSocket;
+
+static std::string repetitive(size_t len, int seed) {
+    std::string s;
+    while (s.size() < len)
+        s += "{\"id\":" + std::to_string(seed++ % 100) + ",\"status\":\"ok\",\"payload\":\"aaaa\"}";
+    s.resize(len);
+    return s;
+}
+
+/**
+ * echo frames of assorted sizes through a pair of CompressedTransports
+ * @return codec settled on
+ */
+static Codec roundtrip(const CompressionOptions &a, const CompressionOptions &b,
+                       uint64_t *raw = nullptr, uint64_t *wire = nullptr) {
+    int sv[2];
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    const size_t sizes[] = {0, 1, 100, 255, 256, 4000, 70000, 1 << 20};
+    std::thread echo([&]() {
+        CompressedTransport t(sv[1], b);
+        std::vector<char> buf(1 << 20);
+        for (size_t i = 0; i < sizeof sizes / sizeof sizes[0]; ++i) {
+            size_t n = t.recv_frame(buf.data(), buf.size());
+            t.send_frame(buf.data(), n);
+        }
+    });
+    Codec codec;
+    {
+        CompressedTransport t(sv[0], a);
+        codec = t.codec();
+        std::vector<char> in(1 << 20);
+        for (size_t len : sizes) {
+            std::string out = repetitive(len, (int) len);
+            t.send_frame(out.data(), out.size());
+            size_t n = t.recv_frame(in.data(), in.size());
+            EXPECT_EQ(out, std::string(in.data(), n));
+        }
+        if (raw)
+            *raw = t.raw_bytes();
+        if (wire)
+            *wire = t.wire_bytes();
+    }
+    echo.join();
+    close(sv[0]);
+    close(sv[1]);
+    return codec;
+}
+
+TEST(compressedtransport, negotiates_best_common_codec) {
+    CompressionOptions all;
+    Codec best = CompressedTransport::available(Codec::ZSTD) ? Codec::ZSTD
+               : CompressedTransport::available(Codec::LZ4) ? Codec::LZ4 : Codec::NONE;
+    uint64_t raw, wire;
+    EXPECT_EQ(best, roundtrip(all, all, &raw, &wire));
+    if (best != Codec::NONE) {
+        EXPECT_LT(wire * 4, raw);
+    }
+
+    // either side may rule a codec out
+    CompressionOptions none;
+    none.codecs = codec_bit(Codec::NONE);
+    EXPECT_EQ(Codec::NONE, roundtrip(all, none, &raw, &wire));
+    EXPECT_GT(wire, raw);
+}
+
+TEST(compressedtransport, lz4) {
+    if (!CompressedTransport::available(Codec::LZ4))
+        GTEST_SKIP() << "built without lz4";
+    CompressionOptions lz4;
+    lz4.codecs = codec_bit(Codec::LZ4);
+    CompressionOptions all;
+    EXPECT_EQ(Codec::LZ4, roundtrip(lz4, all));
+}
+
+TEST(compressedtransport, dictionary_only_when_both_have_it) {
+    if (CompressedTransport::available() == codec_bit(Codec::NONE))
+        GTEST_SKIP() << "built without codecs";
+    CompressionOptions dict;
+    dict.dictionary = repetitive(4096, 7);
+    for (unsigned c : {codec_bit(Codec::LZ4), codec_bit(Codec::ZSTD)}) {
+        if (!(CompressedTransport::available() & c))
+            continue;
+        dict.codecs = c;
+        roundtrip(dict, dict);
+        CompressionOptions other = dict;
+        other.dictionary = repetitive(4096, 8);
+        roundtrip(dict, other);
+    }
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    dict.codecs = ~0u;
+    std::thread peer([&]() { CompressedTransport t(sv[1], dict); });
+    CompressedTransport t(sv[0], dict);
+    EXPECT_TRUE(t.uses_dictionary());
+    peer.join();
+    close(sv[0]);
+    close(sv[1]);
+}
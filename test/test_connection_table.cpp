@@ -0,0 +1,104 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/connection_table.h"
+#include "../src/transport.h"
+#include <fcntl.h>
+using namespace bylSocket;
+
+TEST(connectiontable, stale_handle_after_fd_reuse) {
+    BufferPool pool(256);
+    ConnectionTable table(pool);
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    ConnectionTable::Handle h = table.open(sv[0], 42);
+    EXPECT_TRUE(table.valid(h));
+    EXPECT_EQ(sv[0], ConnectionTable::fd(h));
+    EXPECT_EQ(42u, table.user(h));
+    EXPECT_EQ(h, table.lookup(sv[0]));
+    EXPECT_EQ(1u, table.size());
+
+    EXPECT_TRUE(table.close(h));
+    EXPECT_FALSE(table.close(h));
+    EXPECT_FALSE(table.valid(h));
+    EXPECT_EQ(ConnectionTable::INVALID, table.lookup(sv[0]));
+    EXPECT_THROW(table.user(h), std::logic_error);
+
+    // the kernel hands out the lowest free fd, i.e. the one just closed
+    int reused = fcntl(sv[1], F_DUPFD, sv[0]);
+    ASSERT_EQ(sv[0], reused);
+    ConnectionTable::Handle h2 = table.open(reused);
+    EXPECT_NE(h, h2);
+    EXPECT_FALSE(table.valid(h));
+    EXPECT_TRUE(table.valid(h2));
+    EXPECT_THROW(table.open(reused), std::logic_error);
+    ::close(sv[1]);
+}
+
+TEST(connectiontable, buffer_only_while_data_in_flight) {
+    BufferPool pool(256);
+    ConnectionTable table(pool);
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    ConnectionTable::Handle h = table.open(sv[0]);
+    EXPECT_EQ(nullptr, table.data(h));
+
+    // nothing to read: the buffer is handed straight back
+    EXPECT_EQ(-1, table.fill(h));
+    EXPECT_EQ(EAGAIN, errno);
+    EXPECT_EQ(0u, table.buffers_in_use());
+
+    write_full(sv[1], "hello world", 11);
+    EXPECT_EQ(11, table.fill(h));
+    EXPECT_EQ(1u, table.buffers_in_use());
+    EXPECT_EQ("hello world", std::string(table.data(h), table.buffered(h)));
+
+    table.consume(h, 6);
+    EXPECT_EQ("world", std::string(table.data(h), table.buffered(h)));
+    EXPECT_EQ(1u, table.buffers_in_use());
+    table.consume(h, 5);
+    EXPECT_EQ(0u, table.buffers_in_use());
+    EXPECT_EQ(nullptr, table.data(h));
+
+    // a full buffer is told apart from EOF
+    std::string big(300, 'b');
+    write_full(sv[1], big.data(), big.size());
+    EXPECT_EQ(256, table.fill(h));
+    EXPECT_EQ(-1, table.fill(h));
+    EXPECT_EQ(ENOBUFS, errno);
+    table.consume(h, 256);
+    EXPECT_EQ(44, table.fill(h));
+    table.consume(h, 44);
+
+    // EOF
+    ::close(sv[1]);
+    EXPECT_EQ(0, table.fill(h));
+    EXPECT_EQ(0u, table.buffers_in_use());
+}
+
+TEST(connectiontable, idle_slot_is_small) {
+    BufferPool pool;
+    ConnectionTable table(pool);
+    std::vector<int> peers;
+    for (int i = 0; i < 64; ++i) {
+        int sv[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+        table.open(sv[0], i);
+        peers.push_back(sv[1]);
+    }
+    EXPECT_EQ(64u, table.size());
+    EXPECT_EQ(0u, table.buffers_in_use());
+
+    size_t closed = 0;
+    table.for_each([&](ConnectionTable::Handle h) {
+        if (table.user(h) % 2 == 0 && table.close(h))
+            ++closed;
+    });
+    EXPECT_EQ(32u, closed);
+    EXPECT_EQ(32u, table.size());
+    // slots only, sized by the highest fd seen
+    EXPECT_LE(table.memory_bytes(), 64 * 1024u);
+    for (int fd : peers)
+        ::close(fd);
+}
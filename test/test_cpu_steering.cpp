@@ -0,0 +1,89 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/cpu_steering.h"
+#include "../src/busy_poll.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::CpuListeners;
+
+typedef Socket<Domain::IP4, Type::STREAM> Tcp;
+
+/**
+ * connect n clients from the cpu this thread runs on, wait until all
+ * got served
+ * @return that cpu
+ */
+static int connect_clients(std::atomic<int> &served, int n, const char *port) {
+    cpu_set_t saved;
+    sched_getaffinity(0, sizeof saved, &saved);
+    int cpu = current_cpu();
+    // loopback handshakes are processed on the connecting cpu
+    pin_thread(cpu);
+    std::vector<Tcp> clients(n);
+    for (auto &c : clients)
+        c.connect("127.0.0.1", port);
+    for (int i = 0; i < 500 && served < n; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    sched_setaffinity(0, sizeof saved, &saved);
+    return cpu;
+}
+
+TEST(cpusteering, served_on_own_cpu) {
+    std::atomic<int> served(0), wrong_cpu(0);
+    CpuListeners<Domain::IP4> group("50220", "127.0.0.1", [&](int fd, EventLoop &) {
+        int arrived = incoming_cpu(fd);
+        if (arrived >= 0 && arrived != current_cpu())
+            ++wrong_cpu;
+        close(fd);
+        ++served;
+    });
+    EXPECT_EQ((unsigned) sysconf(_SC_NPROCESSORS_ONLN), group.cpus());
+    if (group.steering() == Steering::NONE)
+        GTEST_SKIP() << "neither SO_ATTACH_REUSEPORT_CBPF nor SO_INCOMING_CPU";
+    connect_clients(served, 32, "50220");
+    EXPECT_EQ(32, served);
+    EXPECT_EQ(32u, group.stats().served);
+    if (group.steering() == Steering::CBPF) {
+        EXPECT_EQ(0, wrong_cpu);
+        EXPECT_EQ(0u, group.stats().foreign);
+    }
+}
+
+TEST(cpusteering, cbpf_picks_listener_of_cpu) {
+    std::atomic<int> served(0);
+    // more listeners than cpus may be online, cpu % 4 picks one
+    CpuListeners<Domain::IP4> group("50221", "127.0.0.1", [&](int fd, EventLoop &) {
+        close(fd);
+        ++served;
+    }, 4);
+    if (group.steering() != Steering::CBPF)
+        GTEST_SKIP() << "SO_ATTACH_REUSEPORT_CBPF not supported";
+    unsigned cpu = (unsigned) connect_clients(served, 32, "50221") % 4;
+    ASSERT_EQ(32, served);
+    EXPECT_EQ(32u, group.stats(cpu).served);
+    EXPECT_EQ(0u, group.stats().handed_on);
+}
+
+TEST(cpusteering, incoming_cpu_hands_on) {
+    std::atomic<int> served(0);
+    CpuListeners<Domain::IP4> group("50222", "127.0.0.1", [&](int fd, EventLoop &loop) {
+        // the handler may keep using the serving thread's loop
+        loop.add(fd, EPOLLIN, [fd, &loop](uint32_t) {
+            loop.remove(fd);
+            close(fd);
+        });
+        ++served;
+    }, 4, Steering::INCOMING_CPU);
+    if (group.steering() != Steering::INCOMING_CPU)
+        GTEST_SKIP() << "SO_INCOMING_CPU not supported";
+    unsigned cpu = (unsigned) connect_clients(served, 32, "50222");
+    ASSERT_EQ(32, served);
+    if (cpu < 4) {
+        // the hash spreads them, the others hand theirs on to this cpu's
+        EXPECT_EQ(32u, group.stats(cpu).served);
+        EXPECT_EQ(0u, group.stats(cpu).handed_on);
+    }
+    EXPECT_EQ(0u, group.stats().foreign);
+}
@@ -0,0 +1,48 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::BufferedSocket;
+
+TEST(fdpassing, seqpacket_scm_rights) {
+    Socket<Domain::UNIX, Type::SEQPACKET> srv;
+    srv.bind("bylsocket_test_fdpassing");
+    srv.listen(4);
+    Socket<Domain::UNIX, Type::SEQPACKET> cli;
+    cli.connect("bylsocket_test_fdpassing");
+    auto conn = srv.accept();
+
+    int pfd[2];
+    ASSERT_EQ(0, pipe(pfd));
+    cli.send_fds(pfd + 1, 1, "pipe");
+    close(pfd[1]);
+
+    int got[2] = {-1, -1};
+    char msg[16] = {0};
+    ASSERT_EQ(1, conn.recv_fds(got, 2, msg, sizeof msg));
+    EXPECT_STREQ("pipe", msg);
+    ASSERT_EQ(3, write(got[0], "abc", 3));
+    close(got[0]);
+
+    char buf[4] = {0};
+    EXPECT_EQ(3, read(pfd[0], buf, sizeof buf));
+    EXPECT_STREQ("abc", buf);
+    close(pfd[0]);
+}
+
+TEST(fdpassing, seqpacket_keeps_boundaries) {
+    Socket<Domain::UNIX, Type::SEQPACKET> srv;
+    srv.bind("bylsocket_test_seqpacket");
+    srv.listen(4);
+    BufferedSocket<Domain::UNIX, Type::SEQPACKET> cli;
+    cli.connect("bylsocket_test_seqpacket");
+    BufferedSocket<Domain::UNIX, Type::SEQPACKET> conn(srv.accept());
+
+    cli.send("first");
+    cli.send("second");
+    EXPECT_STREQ("first", conn.recv());
+    EXPECT_STREQ("second", conn.recv());
+}
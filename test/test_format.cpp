@@ -0,0 +1,72 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include <climits>
+#include "../src/tmpl_socket.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::BufferedSocket;
+
+static std::string fmt(const char *f) {
+    std::string s;
+    format_to(s, f);
+    return s;
+}
+template<typename ... Args>
+static std::string fmt(const char *f, const Args &... args) {
+    std::string s;
+    format_to(s, f, args...);
+    return s;
+}
+
+TEST(format, integers) {
+    EXPECT_EQ("0 7 -42 100", fmt("{} {} {} {}", 0, 7u, -42L, (short) 100));
+    EXPECT_EQ(std::to_string(LLONG_MIN), fmt("{}", LLONG_MIN));
+    EXPECT_EQ(std::to_string(ULLONG_MAX), fmt("{}", ULLONG_MAX));
+    EXPECT_EQ("x=1 true c", fmt("x={} {} {}", 1, true, 'c'));
+}
+
+TEST(format, floats) {
+    EXPECT_EQ("1.5", fmt("{}", 1.5));
+    EXPECT_EQ("3", fmt("{}", 3.0));
+    EXPECT_EQ("-0.25", fmt("{}", -0.25f));
+    EXPECT_EQ("0.13", fmt("{:.2}", 0.125));
+    EXPECT_EQ("2.000", fmt("{:.3}", 2.0));
+    EXPECT_EQ("1e+30", fmt("{}", 1e30));
+    EXPECT_EQ("0.000012 0 0", fmt("{} {} {}", 1.2345e-5, 1e-9, -1e-9));
+    EXPECT_EQ("nan inf", fmt("{} {}", NAN, INFINITY));
+}
+
+TEST(format, literals) {
+    EXPECT_EQ("{} a} b", fmt("{{}} a} b"));
+    EXPECT_EQ("s: str", fmt("s: {}", std::string("str")));
+    EXPECT_ANY_THROW(fmt("{} {}", 1));
+    EXPECT_ANY_THROW(fmt("{}", 1, 2));
+    static_assert(fmt_detail::count_placeholders("{} {{}} {:.3}") == 2, "");
+}
+
+TEST(format, send_fmt) {
+    Socket<Domain::UNIX, Type::SEQPACKET> srv;
+    srv.bind("bylsocket_test_send_fmt");
+    srv.listen(4);
+    BufferedSocket<Domain::UNIX, Type::SEQPACKET> cli;
+    cli.connect("bylsocket_test_send_fmt");
+    auto conn = srv.accept();
+
+    std::string big(2000, 'z');
+    checked_send_fmt(cli, "{}:{}", big, 1);
+    char buf[4096];
+    ASSERT_EQ((ssize_t) big.size() + 3, ::recv(conn.fd(), buf, sizeof buf, 0));
+    EXPECT_EQ(big + ":1", std::string(buf));
+
+    cli.set_fmt_nul(false);
+    cli.send_fmt("n={}", 5);
+    ASSERT_EQ(3, ::recv(conn.fd(), buf, sizeof buf, 0));
+    EXPECT_EQ(0, memcmp("n=5", buf, 3));
+
+    // a literal without placeholders, no arguments
+    checked_send_fmt(cli, "bye {{}}");
+    ASSERT_EQ(6, ::recv(conn.fd(), buf, sizeof buf, 0));
+    EXPECT_EQ(0, memcmp("bye {}", buf, 6));
+}
@@ -0,0 +1,64 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+#include "../src/handoff.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::BufferedSocket;
+using bylSocket::Tmpl::ListenedSocket;
+
+typedef Socket<Domain::UNIX, Type::STREAM> UnixSocket;
+
+TEST(handoff, listener_survives_predecessor) {
+    HandoffFds got;
+    EXPECT_FALSE(handoff_take("bylsocket_test_handoff", got));
+
+    std::unique_ptr<ListenedSocket<Domain::UNIX>> old(
+            new ListenedSocket<Domain::UNIX>("bylsocket_test_handoff_srv"));
+    // queued in the backlog before the handoff
+    BufferedSocket<Domain::UNIX, Type::STREAM> early;
+    early.connect("bylsocket_test_handoff_srv");
+
+    bool offered = false;
+    std::thread predecessor([&]() {
+        offered = handoff_offer("bylsocket_test_handoff", {old->fd()},
+                                {}, 5000);
+        old.reset();
+    });
+    while (!handoff_take("bylsocket_test_handoff", got))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    predecessor.join();
+    ASSERT_TRUE(offered);
+    ASSERT_EQ(1u, got.listeners.size());
+    EXPECT_TRUE(got.connections.empty());
+
+    UnixSocket successor(got.listeners[0], Status::LISTENING);
+    BufferedSocket<Domain::UNIX, Type::STREAM> late;
+    late.connect("bylsocket_test_handoff_srv");
+    for (auto *c : {&early, &late}) {
+        BufferedSocket<Domain::UNIX, Type::STREAM> conn(successor.accept());
+        c->send("hi");
+        EXPECT_STREQ("hi", conn.recv());
+    }
+}
+
+TEST(handoff, offer_times_out) {
+    EXPECT_FALSE(handoff_offer("bylsocket_test_handoff_none", {0}, {}, 10));
+}
+
+TEST(handoff, drainer) {
+    Drainer d;
+    std::unique_ptr<Drainer::Guard> g(new Drainer::Guard(d));
+    EXPECT_TRUE(g->admitted());
+    EXPECT_FALSE(d.drain(std::chrono::milliseconds(10)));
+    EXPECT_FALSE(Drainer::Guard(d).admitted());
+    std::thread t([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        g.reset();
+    });
+    EXPECT_TRUE(d.drain(std::chrono::milliseconds(5000)));
+    t.join();
+    EXPECT_EQ(0u, d.active());
+}
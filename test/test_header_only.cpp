@@ -0,0 +1,23 @@
+//
+// Created on 10/19/26.
+//
+// the Tmpl templates compiled into this translation unit
+#define BYLSOCKET_HEADER_ONLY
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::BufferedSocket;
+
+TEST(headeronly, buffered_dgram_roundtrip) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, sv));
+    BufferedSocket<Domain::UNIX, Type::DGRAM> a(
+            Socket<Domain::UNIX, Type::DGRAM>(sv[0], Status::CONNECTED));
+    BufferedSocket<Domain::UNIX, Type::DGRAM> b(
+            Socket<Domain::UNIX, Type::DGRAM>(sv[1], Status::CONNECTED));
+    a.send("inlined");
+    EXPECT_STREQ("inlined", b.recv());
+    b.send_fmt("{} + {} = {}", 1, 2, 3);
+    EXPECT_STREQ("1 + 2 = 3", a.recv());
+}
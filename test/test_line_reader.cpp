@@ -0,0 +1,76 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+#include "../src/line_reader.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+TEST(linereader, find_byte_agrees_with_scalar) {
+    std::vector<char> buf(1000);
+    for (size_t i = 0; i < buf.size(); ++i)
+        buf[i] = (char) (i * 131 % 251);
+    for (size_t off = 0; off < 70; ++off)
+        for (size_t n = 0; n < 300; n += 7)
+            for (char c : {'\0', '\n', (char) 200, (char) 250})
+                ASSERT_EQ(find_byte_scalar(&buf[off], n, c),
+                          find_byte(&buf[off], n, c));
+}
+
+TEST(linereader, records_split_across_reads) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_line_reader");
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect("bylsocket_test_line_reader");
+    auto conn = srv.accept();
+
+    std::string long_line(10000, 'l');
+    std::thread writer([&]() {
+        const char *parts[] = {"fir", "st\nsec", "ond\n\n", long_line.c_str(),
+                               "\ntail"};
+        for (const char *p : parts) {
+            ASSERT_EQ((ssize_t) strlen(p), ::send(cli.fd(), p, strlen(p), 0));
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        shutdown(cli.fd(), SHUT_WR);
+    });
+
+    LineReader r(conn.fd(), 1 << 16, 16);
+    Slice s;
+    std::vector<std::string> got;
+    while (r.read_line(s))
+        got.push_back(s.str());
+    writer.join();
+    std::vector<std::string> want = {"first", "second", "", long_line, "tail"};
+    EXPECT_EQ(want, got);
+}
+
+TEST(linereader, record_too_long) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_line_reader_max");
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect("bylsocket_test_line_reader_max");
+    auto conn = srv.accept();
+    std::string s(300, 'x');
+    ::send(cli.fd(), s.data(), s.size(), 0);
+    EXPECT_ANY_THROW(LineReader(conn.fd(), 256, 0));
+    LineReader r(conn.fd(), 256, 16);
+    Slice line;
+    EXPECT_ANY_THROW(r.read_line(line));
+}
+
+TEST(linereader, other_delimiter_after_timeout) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    struct timeval tv = {0, 10000};
+    ASSERT_EQ(0, setsockopt(sv[0], SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv));
+    ASSERT_EQ(3, ::send(sv[1], "a,b", 3, 0));
+    LineReader r(sv[0]);
+    Slice s;
+    // no '\n' before the timeout, the ',' is buffered already
+    EXPECT_ANY_THROW(r.read_until('\n', s));
+    ASSERT_TRUE(r.read_until(',', s));
+    EXPECT_EQ("a", std::string(s.data, s.size));
+    close(sv[0]);
+    close(sv[1]);
+}
@@ -0,0 +1,33 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/metrics.h"
+using namespace bylSocket;
+
+TEST(metrics, histogram_percentiles) {
+    Histogram h;
+    for (uint64_t v = 1; v <= 100000; ++v)
+        h.record(v);
+    EXPECT_EQ(100000u, h.count());
+    EXPECT_EQ(1u, h.min());
+    EXPECT_EQ(100000u, h.max());
+    EXPECT_NEAR(50000.5, h.mean(), 1e-6);
+    // within the 2^-7 relative precision
+    EXPECT_NEAR(50000, h.percentile(50), 50000 / 128.0);
+    EXPECT_NEAR(99000, h.percentile(99), 99000 / 128.0);
+    EXPECT_EQ(100000u, h.percentile(100));
+}
+
+TEST(metrics, histogram_merge_reset) {
+    Histogram a, b;
+    a.record_n(10, 3);
+    b.record(1ull << 40);
+    a.merge(b);
+    EXPECT_EQ(4u, a.count());
+    EXPECT_EQ(10u, a.percentile(75));
+    EXPECT_NEAR(1ull << 40, a.percentile(100), (1ull << 40) / 128.0);
+    a.reset();
+    EXPECT_EQ(0u, a.count());
+    EXPECT_EQ(0u, a.percentile(50));
+}
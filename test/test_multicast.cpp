@@ -0,0 +1,122 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/multicast.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::MulticastSocket;
+typedef SequenceGapDetector::Verdict Verdict;
+
+TEST(sequencegapdetector, loss_reorder_and_duplicates) {
+    SequenceGapDetector d;
+    EXPECT_EQ(Verdict::IN_ORDER, d.track(100));
+    EXPECT_EQ(Verdict::IN_ORDER, d.track(101));
+    EXPECT_EQ(Verdict::GAP, d.track(105));
+    EXPECT_EQ(3u, d.missing());
+    EXPECT_EQ(1u, d.gaps());
+    EXPECT_EQ(106u, d.expected());
+
+    EXPECT_EQ(Verdict::LATE, d.track(103));
+    EXPECT_EQ(2u, d.missing());
+    EXPECT_EQ(Verdict::DUPLICATE, d.track(103));
+    EXPECT_EQ(Verdict::DUPLICATE, d.track(105));
+    EXPECT_EQ(Verdict::DUPLICATE, d.track(100));
+
+    // far ahead: everything in between is missing, old ones are stale
+    EXPECT_EQ(Verdict::GAP, d.track(300));
+    EXPECT_EQ(2u + 194u, d.missing());
+    EXPECT_EQ(Verdict::STALE, d.track(102));
+    EXPECT_EQ(Verdict::LATE, d.track(299));
+    EXPECT_EQ(Verdict::IN_ORDER, d.track(301));
+
+    EXPECT_EQ(11u, d.received());
+    EXPECT_EQ(2u, d.late());
+    EXPECT_EQ(3u, d.duplicates());
+    EXPECT_EQ(1u, d.stale());
+}
+
+template<Domain D>
+static void fan_out(const char *group, const char *port) {
+    MulticastSocket<D> sub[3];
+    for (auto &s : sub) {
+        s.subscribe(group, port, "lo");
+        s.set_opt(Options::RCVTIMEO, 1);
+    }
+    MulticastSocket<D> pub;
+    pub.set_interface("lo");
+    pub.set_loop(true);
+    pub.set_ttl(0);
+    pub.publish_to(group, port);
+
+    const int N = 100;
+    for (int i = 0; i < N; ++i) {
+        // skip a few to open gaps
+        if (i % 10 == 5)
+            pub.publish("x", 1);
+        std::string msg = "tick " + std::to_string(i);
+        pub.publish(msg.data(), msg.size());
+    }
+    for (auto &s : sub) {
+        SequenceGapDetector d;
+        char buf[64];
+        uint64_t seq;
+        for (int i = 0; i < N + N / 10; ++i) {
+            size_t n = s.receive(buf, sizeof buf, seq);
+            if (n == 1)
+                continue; // the one a lossy network would have dropped
+            d.track(seq);
+        }
+        EXPECT_EQ((uint64_t) N, d.received());
+        EXPECT_EQ((uint64_t) N / 10, d.gaps());
+        EXPECT_EQ((uint64_t) N / 10, d.missing());
+        EXPECT_EQ(0u, d.duplicates());
+    }
+
+    // after leaving, nothing more arrives
+    sub[0].leave(group, "lo");
+    pub.publish("bye", 3);
+    char buf[8];
+    uint64_t seq;
+    EXPECT_EQ(3u, sub[1].receive(buf, sizeof buf, seq));
+    EXPECT_THROW(sub[0].receive(buf, sizeof buf, seq), std::logic_error);
+}
+
+TEST(multicast, ip4_fan_out_on_loopback) {
+    fan_out<Domain::IP4>("239.255.42.99", "47101");
+}
+
+TEST(multicast, ip4_source_specific) {
+    MulticastSocket<Domain::IP4> sub, other;
+    for (auto *s : {&sub, &other}) {
+        s->set_opt(Options::REUSEADDR);
+        s->bind("232.1.2.3", "47102");
+        s->set_opt(Options::RCVTIMEO, 1);
+    }
+    sub.join_source("232.1.2.3", "127.0.0.1", "lo");
+    other.join_source("232.1.2.3", "127.0.0.2", "lo");
+
+    MulticastSocket<Domain::IP4> pub;
+    pub.set_interface("lo");
+    // pin the source address, it would be the host's primary one otherwise
+    pub.bind("127.0.0.1", "0");
+    pub.publish_to("232.1.2.3", "47102");
+    pub.publish("ssm", 3);
+    char buf[8];
+    uint64_t seq = 42;
+    EXPECT_EQ(3u, sub.receive(buf, sizeof buf, seq));
+    EXPECT_EQ(0u, seq);
+    EXPECT_THROW(other.receive(buf, sizeof buf, seq), std::logic_error);
+    sub.leave_source("232.1.2.3", "127.0.0.1", "lo");
+}
+
+TEST(multicast, ip6_fan_out_on_loopback) {
+    try {
+        MulticastSocket<Domain::IP6> probe;
+        probe.join("ff15::4242", "lo");
+        probe.set_interface("lo");
+        probe.publish_to("ff15::4242", "47103");
+    } catch (std::logic_error &) {
+        GTEST_SKIP() << "no ipv6 multicast on lo";
+    }
+    fan_out<Domain::IP6>("ff15::4242", "47103");
+}
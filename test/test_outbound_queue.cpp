@@ -0,0 +1,83 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+#include "../src/outbound_queue.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+TEST(outboundqueue, watermarks) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_outbound");
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect("bylsocket_test_outbound");
+    auto conn = srv.accept();
+
+    MemoryBudget budget;
+    OutboundQueue q(cli.fd(), 256 << 10, 64 << 10, &budget);
+    int highs = 0, lows = 0;
+    q.on_high([&]() { ++highs; });
+    q.on_low([&]() { ++lows; });
+
+    std::string chunk(16 << 10, '\0');
+    size_t sent = 0;
+    while (!q.paused()) {
+        for (size_t k = 0; k < chunk.size(); ++k)
+            chunk[k] = (char) (sent + k);
+        ASSERT_TRUE(q.send(chunk.data(), chunk.size()));
+        sent += chunk.size();
+    }
+    EXPECT_EQ(1, highs);
+    EXPECT_EQ(q.queued(), budget.used());
+
+    std::vector<char> buf(64 << 10);
+    size_t got = 0;
+    while (got < sent) {
+        q.flush();
+        ssize_t n = ::recv(conn.fd(), buf.data(), buf.size(), 0);
+        ASSERT_GT(n, 0);
+        for (ssize_t k = 0; k < n; ++k)
+            ASSERT_EQ((char) (got + k), buf[k]);
+        got += n;
+    }
+    EXPECT_TRUE(q.flush());
+    EXPECT_FALSE(q.paused());
+    EXPECT_EQ(1, lows);
+    EXPECT_EQ(0u, budget.used());
+}
+
+TEST(outboundqueue, budget_rejects) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_outbound_budget");
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect("bylsocket_test_outbound_budget");
+    auto conn = srv.accept();
+
+    MemoryBudget budget(1 << 20);
+    OutboundQueue q(cli.fd(), SIZE_MAX, SIZE_MAX, &budget);
+    std::string chunk(64 << 10, 'x');
+    int accepted = 0;
+    while (q.send(chunk.data(), chunk.size()))
+        ++accepted;
+    EXPECT_GT(accepted, 0);
+    EXPECT_LE(budget.used(), budget.limit());
+    EXPECT_FALSE(q.send(std::make_shared<const std::string>(chunk)));
+}
+
+TEST(outboundqueue, failed_send_returns_budget) {
+    MemoryBudget budget;
+    std::string chunk(4 << 10, 'x');
+    {
+        ListenedSocket<Domain::UNIX> srv("bylsocket_test_outbound_epipe");
+        Socket<Domain::UNIX, Type::STREAM> cli;
+        cli.connect("bylsocket_test_outbound_epipe");
+        OutboundQueue q(cli.fd(), SIZE_MAX, SIZE_MAX, &budget);
+        {
+            auto conn = srv.accept();
+        }
+        EXPECT_ANY_THROW(q.send(chunk.data(), chunk.size()));
+        EXPECT_ANY_THROW(q.send(std::make_shared<const std::string>(chunk)));
+        EXPECT_EQ(0u, budget.used());
+    }
+    EXPECT_EQ(0u, budget.used());
+}
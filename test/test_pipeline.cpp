@@ -0,0 +1,146 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/pipeline.h"
+#include "../src/transport.h"
+#include <atomic>
+#include <vector>
+using namespace bylSocket;
+
+static std::string frame_id(const std::vector<char> &buf) {
+    return std::string(buf.data(), 4);
+}
+
+TEST(pipelinedclient, out_of_order_responses) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    const int N = 64;
+    // answers each batch of N requests in reverse order
+    std::thread server([&]() {
+        SocketTransport t(sv[1]);
+        std::vector<std::vector<char>> reqs;
+        std::vector<char> buf(1024);
+        for (int i = 0; i < N; ++i) {
+            size_t n = t.recv_frame(buf.data(), buf.size());
+            reqs.emplace_back(buf.begin(), buf.begin() + n);
+        }
+        for (int i = N - 1; i >= 0; --i) {
+            std::string resp = frame_id(reqs[i]) + "re:" +
+                               std::string(reqs[i].begin() + 4, reqs[i].end());
+            t.send_frame(resp.data(), resp.size());
+        }
+    });
+    {
+        PipelinedClient cli(sv[0]);
+        std::vector<std::future<std::string>> fs;
+        for (int i = 0; i < N; ++i)
+            fs.push_back(cli.call("req" + std::to_string(i)));
+        for (int i = 0; i < N; ++i)
+            EXPECT_EQ("re:req" + std::to_string(i), fs[i].get());
+        EXPECT_EQ(0u, cli.in_flight());
+        EXPECT_EQ((uint64_t) N, cli.requests());
+        server.join();
+    }
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(pipelinedclient, concurrent_callers_share_writes) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    const int THREADS = 4, PER_THREAD = 2000;
+    std::thread server([&]() {
+        SocketTransport t(sv[1]);
+        std::vector<char> buf(1024);
+        for (int i = 0; i < THREADS * PER_THREAD; ++i) {
+            size_t n = t.recv_frame(buf.data(), buf.size());
+            t.send_frame(buf.data(), n);
+        }
+    });
+    std::atomic<int> ok(0);
+    {
+        PipelinedClient cli(sv[0], 128);
+        std::vector<std::thread> callers;
+        for (int k = 0; k < THREADS; ++k)
+            callers.emplace_back([&, k]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    std::string req = std::to_string(k) + ":" + std::to_string(i);
+                    cli.call(req.data(), req.size(), [&ok, req](int err, std::string &&resp) {
+                        if (!err && resp == req)
+                            ++ok;
+                    });
+                }
+            });
+        for (auto &t : callers)
+            t.join();
+        server.join();
+        while (cli.in_flight())
+            std::this_thread::yield();
+    }
+    EXPECT_EQ(THREADS * PER_THREAD, ok.load());
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(pipelinedclient, queued_calls_share_one_write) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    const int QUEUED = 8;
+    std::atomic<int> ok(0);
+    {
+        PipelinedClient cli(sv[0]);
+        // larger than the socket buffer: its writer blocks until the
+        // server reads, meanwhile the other calls only get queued
+        std::string big(4 << 20, 'b');
+        std::thread writer([&]() {
+            cli.call(big.data(), big.size(), [&](int err, std::string &&resp) {
+                if (!err && resp.size() == big.size())
+                    ++ok;
+            });
+        });
+        while (cli.requests() < 1)
+            std::this_thread::yield();
+        for (int i = 0; i < QUEUED; ++i)
+            cli.call("queued", 6, [&](int err, std::string &&resp) {
+                if (!err && resp == "queued")
+                    ++ok;
+            });
+        EXPECT_EQ((uint64_t) QUEUED + 1, cli.requests());
+        EXPECT_EQ(0u, cli.writes());
+
+        std::thread server([&]() {
+            SocketTransport t(sv[1]);
+            std::vector<char> buf(big.size() + 4);
+            for (int i = 0; i < QUEUED + 1; ++i) {
+                size_t n = t.recv_frame(buf.data(), buf.size());
+                t.send_frame(buf.data(), n);
+            }
+        });
+        writer.join();
+        server.join();
+        while (cli.in_flight())
+            std::this_thread::yield();
+        // the big one, then all queued ones at once
+        EXPECT_EQ(2u, cli.writes());
+    }
+    EXPECT_EQ(QUEUED + 1, ok.load());
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(pipelinedclient, peer_gone_fails_pending) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    PipelinedClient cli(sv[0]);
+    close(sv[0]);
+    auto f1 = cli.call("lost");
+    auto f2 = cli.call("lost too");
+    close(sv[1]);
+    EXPECT_THROW(f1.get(), std::logic_error);
+    EXPECT_THROW(f2.get(), std::logic_error);
+    // later calls fail right away
+    int err = 0;
+    cli.call("late", 4, [&](int e, std::string &&) { err = e; });
+    EXPECT_NE(0, err);
+}
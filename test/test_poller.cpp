@@ -0,0 +1,82 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/byl_socket.hpp"
+#include "../src/tmpl_socket.h"
+#include "../src/poller.h"
+#include "../src/transport.h"
+#include <algorithm>
+using namespace bylSocket;
+
+typedef Tmpl::Socket<Domain::UNIX, Type::STREAM> UnixSocket;
+
+TEST(poller, returns_ready_subset_of_mixed_sockets) {
+    std::vector<UnixSocket> tmpl;
+    std::vector<Socket> plain;
+    std::vector<int> peers;
+    for (int i = 0; i < 6; ++i) {
+        int sv[2];
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+        if (i % 2)
+            plain.emplace_back(sv[0], Domain::UNIX, Type::STREAM, Status::CONNECTED);
+        else
+            tmpl.emplace_back(sv[0], Status::CONNECTED);
+        peers.push_back(sv[1]);
+    }
+    Poller p;
+    for (auto &s : tmpl)
+        p.add(s);
+    for (auto &s : plain)
+        p.add(s);
+    EXPECT_EQ(6u, p.size());
+    EXPECT_TRUE(p.wait(0).empty());
+
+    // peers[0] and [2] belong to tmpl[0] and [1], peers[3] to plain[1]
+    write_full(peers[0], "a", 1);
+    write_full(peers[2], "b", 1);
+    write_full(peers[3], "c", 1);
+    auto ready = p.wait(1000);
+    ASSERT_EQ(3u, ready.size());
+    std::sort(ready.begin(), ready.end(),
+              [](const Poller::Ready &a, const Poller::Ready &b) { return a.fd < b.fd; });
+    EXPECT_EQ(&tmpl[0], &ready[0].socket<UnixSocket>());
+    EXPECT_EQ(&tmpl[1], &ready[1].socket<UnixSocket>());
+    EXPECT_EQ(&plain[1], &ready[2].socket<Socket>());
+    for (auto &r : ready) {
+        EXPECT_TRUE(r.events & EPOLLIN);
+        char c;
+        EXPECT_EQ(1, ::recv(r.fd, &c, 1, 0));
+    }
+    EXPECT_TRUE(p.wait(0).empty());
+
+    // interest changes and hangups
+    p.modify(tmpl[2], EPOLLOUT);
+    p.remove(plain[2]);
+    close(peers[1]);
+    ready = p.wait(1000);
+    ASSERT_EQ(2u, ready.size());
+    for (auto &r : ready) {
+        if (r.fd == tmpl[2].fd())
+            EXPECT_EQ((uint32_t) EPOLLOUT, r.events);
+        else {
+            EXPECT_EQ(plain[0].fd(), r.fd);
+            EXPECT_TRUE(r.events & EPOLLHUP);
+        }
+    }
+    for (int i = 0; i < 6; ++i)
+        if (i != 1)
+            close(peers[i]);
+}
+
+TEST(poller, times_out) {
+    Poller p;
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    p.add(sv[0], EPOLLIN);
+    uint64_t t0 = time(nullptr);
+    EXPECT_TRUE(p.wait(50).empty());
+    EXPECT_LE(time(nullptr) - t0, 1u);
+    close(sv[0]);
+    close(sv[1]);
+}
@@ -0,0 +1,149 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+#include "../src/rate_limit.h"
+#include "../src/outbound_queue.h"
+#include <sys/socket.h>
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+
+static const uint64_t MS = 1000000;
+
+TEST(ratelimit, token_bucket) {
+    uint64_t t = 1000 * MS;
+    TokenBucket b(1000, 100);
+    // starts full, holds burst at most
+    EXPECT_EQ(100u, b.take(1000, t));
+    EXPECT_EQ(0u, b.take(1, t));
+    EXPECT_EQ(50 * MS, b.wait_ns(50, t));
+    EXPECT_EQ(100 * MS, b.wait_ns(500, t));
+    EXPECT_EQ(50u, b.take(60, t + 50 * MS));
+    b.give_back(20);
+    EXPECT_EQ(20u, b.take(60, t + 50 * MS));
+    // idle for long, still just burst
+    EXPECT_EQ(100u, b.take(1000, t + 10000 * MS));
+
+    TokenBucket unlimited(0, 0);
+    EXPECT_EQ(1u << 30, unlimited.take(1 << 30, t));
+    EXPECT_EQ(0u, unlimited.wait_ns(1 << 30, t));
+}
+
+TEST(ratelimit, shared_group) {
+    uint64_t t = 1000 * MS;
+    TokenBucket group(1000, 100);
+    RateLimiter a(1000, 80, &group), b(1000, 80, &group);
+    EXPECT_EQ(80u, a.grant(1000, t));
+    // the group has 20 left, b's own bucket gets the rest back
+    EXPECT_EQ(20u, b.grant(1000, t));
+    EXPECT_EQ(0u, b.grant(1000, t));
+    EXPECT_EQ(2u, b.throttled());
+    EXPECT_EQ(100u, b.burst() + 20);
+    EXPECT_EQ(40 * MS, b.wait_ns(40, t));
+    t += 40 * MS;
+    EXPECT_EQ(40u, b.grant(1000, t));
+    EXPECT_EQ(0u, a.grant(1000, t));
+}
+
+TEST(ratelimit, loop_timers) {
+    EventLoop loop;
+    std::vector<int> order;
+    loop.add_timer(20 * MS, [&]() { order.push_back(2); });
+    EventLoop::TimerId cancelled = loop.add_timer(5 * MS, [&]() { order.push_back(0); });
+    loop.add_timer(10 * MS, [&]() {
+        order.push_back(1);
+        loop.add_timer(0, [&]() { order.push_back(3); });
+    });
+    EXPECT_TRUE(loop.cancel_timer(cancelled));
+    EXPECT_FALSE(loop.cancel_timer(cancelled));
+    uint64_t t0 = now_ns();
+    while (loop.timers())
+        loop.run_once(1000);
+    EXPECT_GE(now_ns() - t0, 19 * MS);
+    EXPECT_EQ((std::vector<int>{1, 3, 2}), order);
+}
+
+TEST(ratelimit, paced_outbound_queue) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    EventLoop loop;
+    // 1 MB/s, 64 KB at once: 256 KB take 192 ms after the first burst
+    RateLimiter limiter(1 << 20, 64 << 10);
+    MemoryBudget budget;
+    OutboundQueue q(sv[0], SIZE_MAX, SIZE_MAX, &budget);
+    q.set_rate_limit(&limiter, &loop);
+
+    uint64_t t0 = now_ns();
+    std::string msg(16 << 10, 'r');
+    for (int i = 0; i < 16; ++i)
+        ASSERT_TRUE(q.send(msg.data(), msg.size()));
+    EXPECT_TRUE(q.throttled());
+    // a few bytes flow in while sending
+    EXPECT_LE(q.queued(), 192u << 10);
+    EXPECT_GT(q.queued(), 176u << 10);
+
+    size_t got = 0;
+    char buf[64 << 10];
+    while (!q.empty() || got < (256u << 10)) {
+        loop.run_once(1000);
+        ssize_t n;
+        while ((n = ::recv(sv[1], buf, sizeof buf, MSG_DONTWAIT)) > 0)
+            got += n;
+    }
+    double ms = (now_ns() - t0) / 1e6;
+    EXPECT_EQ(256u << 10, got);
+    EXPECT_GE(ms, 180);
+    EXPECT_LT(ms, 1000);
+    EXPECT_FALSE(q.throttled());
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(ratelimit, deferred_recv) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    std::string data(40 << 10, 'd');
+    ASSERT_EQ((ssize_t) data.size(), ::send(sv[0], data.data(), data.size(), 0));
+
+    EventLoop loop;
+    RateLimiter limiter(200 << 10, 8 << 10);
+    size_t got = 0;
+    int deferred = 0;
+    EventLoop::TimerId timer = 0;
+    loop.add(sv[1], EPOLLIN, [&](uint32_t) {
+        char buf[16 << 10];
+        ssize_t n = limiter.recv(sv[1], buf, sizeof buf);
+        if (n > 0)
+            got += n;
+        else if (n == -1 && errno == EAGAIN) {
+            ++deferred;
+            timer = limiter.defer(loop, sv[1], EPOLLIN, 4 << 10);
+        }
+    });
+    uint64_t t0 = now_ns();
+    while (got < data.size())
+        loop.run_once(1000);
+    double ms = (now_ns() - t0) / 1e6;
+    // 8 KB at once, the other 32 KB at 200 KB/s
+    EXPECT_GE(ms, 150);
+    EXPECT_GT(deferred, 0);
+    EXPECT_EQ(data.size(), limiter.granted());
+    // a pending deferral must not outlive fd
+    loop.cancel_timer(timer);
+    loop.remove(sv[1]);
+    close(sv[0]);
+    close(sv[1]);
+}
+
+TEST(ratelimit, kernel_pacing_above_4gb) {
+    Socket<Domain::IP4, Type::STREAM> s;
+    const uint64_t rate = 10ull << 30;
+    s.set_opt(Options::MAX_PACING_RATE, (time_t) rate);
+    uint64_t got = 0;
+    socklen_t len = sizeof got;
+    ASSERT_EQ(0, getsockopt(s.fd(), SOL_SOCKET, SO_MAX_PACING_RATE, &got, &len));
+    if (len != sizeof got)
+        GTEST_SKIP() << "kernel without 64 bit pacing rates";
+    EXPECT_EQ(rate, got);
+}
@@ -0,0 +1,74 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+#include "../src/relay.h"
+#include "../src/transport.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+typedef Socket<Domain::UNIX, Type::STREAM> UnixSocket;
+
+static void relay_half_close(bool use_splice, const char *front,
+                             const char *back) {
+    ListenedSocket<Domain::UNIX> fsrv(front), bsrv(back);
+    UnixSocket client, upstream;
+    client.connect(front);
+    upstream.connect(back);
+    UnixSocket fconn = fsrv.accept(), backend = bsrv.accept();
+
+    EventLoop loop;
+    BufferPool pool(4096);
+    Relay relay(loop, pool, use_splice);
+    Relay::Stats st;
+    relay.add(fconn.fd(), upstream.fd(), [&](const Relay::Stats &s) {
+        st = s;
+        loop.stop();
+    });
+    // the relay holds its own dups
+    fconn = UnixSocket();
+    upstream = UnixSocket();
+
+    const size_t N = 1 << 20;
+    std::string req(N, 'q'), resp(N / 2, 'r');
+    for (size_t i = 0; i < N; ++i)
+        req[i] = (char) (i * 7);
+    std::thread cl([&]() {
+        write_full(client.fd(), req.data(), req.size());
+        shutdown(client.fd(), SHUT_WR);
+        std::string got(resp.size(), '\0');
+        read_full(client.fd(), &got[0], got.size());
+        EXPECT_EQ(resp, got);
+        char c;
+        EXPECT_EQ(0, ::recv(client.fd(), &c, 1, 0));
+    });
+    std::thread be([&]() {
+        std::string got(req.size(), '\0');
+        read_full(backend.fd(), &got[0], got.size());
+        EXPECT_EQ(req, got);
+        char c;
+        // the client's half-close is forwarded
+        EXPECT_EQ(0, ::recv(backend.fd(), &c, 1, 0));
+        write_full(backend.fd(), resp.data(), resp.size());
+        backend = UnixSocket();
+    });
+    loop.run();
+    cl.join();
+    be.join();
+
+    EXPECT_EQ(N, st.bytes[0]);
+    EXPECT_EQ(N / 2, st.bytes[1]);
+    EXPECT_EQ(use_splice, st.spliced[0]);
+    EXPECT_EQ(0u, relay.active());
+    EXPECT_EQ(N, relay.total_bytes(0));
+}
+
+TEST(relay, splice_half_close) {
+    relay_half_close(true, "bylsocket_test_relay_f1", "bylsocket_test_relay_b1");
+}
+
+TEST(relay, buffered_half_close) {
+    relay_half_close(false, "bylsocket_test_relay_f2", "bylsocket_test_relay_b2");
+}
@@ -0,0 +1,108 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include <poll.h>
+#include "../src/tmpl_socket.h"
+#include "../src/timestamping.h"
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+static std::string local_port(int fd) {
+    struct sockaddr_in a;
+    socklen_t len = sizeof a;
+    getsockname(fd, (sockaddr *) &a, &len);
+    return std::to_string(ntohs(a.sin_port));
+}
+
+/**
+ * the kernel turns rx timestamping on lazily, the first packets after
+ * the setsockopt may come without
+ */
+static void warm_up(int tx, KernelTimestamps &rts) {
+    char c;
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(1, ::send(tx, "w", 1, 0));
+        ASSERT_EQ(1, rts.recv(&c, 1));
+        if (rts.last_rx_ns())
+            return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+//! tx timestamps trail the send, give them a moment
+static void collect_all(KernelTimestamps &ts) {
+    for (int i = 0; i < 100 && ts.tx_pending(); ++i) {
+        ts.collect_tx();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(timestamping, udp_loopback) {
+    Socket<Domain::IP4, Type::DGRAM> rx, tx;
+    rx.bind("127.0.0.1", "0");
+    tx.connect("127.0.0.1", local_port(rx.fd()).c_str());
+    KernelTimestamps rts(rx.fd(), false, false);
+    warm_up(tx.fd(), rts);
+    KernelTimestamps tts(tx.fd(), false);
+    Histogram warm = rts.rx_delay();
+
+    char buf[32];
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(5, tts.send("hello", 5));
+        ASSERT_EQ(5, rts.recv(buf, sizeof buf));
+        EXPECT_NE(0u, rts.last_rx_ns());
+        EXPECT_LE(rts.last_rx_ns(), realtime_ns());
+    }
+    collect_all(tts);
+    EXPECT_EQ(10u, rts.rx_delay().count() - warm.count());
+    EXPECT_EQ(10u, tts.tx_delay().count());
+    EXPECT_EQ(0u, tts.tx_pending());
+}
+
+TEST(timestamping, tcp_loopback) {
+    ListenedSocket<Domain::IP4> srv("0");
+    Socket<Domain::IP4, Type::STREAM> cli;
+    cli.connect("127.0.0.1", local_port(srv.fd()).c_str());
+    auto conn = srv.accept();
+    KernelTimestamps rts(conn.fd(), true, false);
+    warm_up(cli.fd(), rts);
+    KernelTimestamps tts(cli.fd(), true);
+    Histogram warm = rts.rx_delay();
+
+    char buf[64];
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(7, tts.send("message", 7));
+        ASSERT_EQ(7, rts.recv(buf, sizeof buf));
+    }
+    collect_all(tts);
+    EXPECT_EQ(10u, rts.rx_delay().count() - warm.count());
+    EXPECT_EQ(10u, tts.tx_delay().count());
+}
+
+TEST(timestamping, timestampns_option) {
+    Socket<Domain::IP4, Type::DGRAM> rx, tx;
+    rx.bind("127.0.0.1", "0");
+    rx.set_opt(Options::TIMESTAMPNS);
+    tx.connect("127.0.0.1", local_port(rx.fd()).c_str());
+    ASSERT_EQ(1, ::send(tx.fd(), "x", 1, 0));
+    char c;
+    struct pollfd p = {rx.fd(), POLLIN, 0};
+    ASSERT_EQ(1, poll(&p, 1, 1000));
+    struct msghdr msg;
+    memset(&msg, 0, sizeof msg);
+    union {
+        char buf[CMSG_SPACE(sizeof(struct timespec))];
+        struct cmsghdr align;
+    } ctl;
+    struct iovec iov = {&c, 1};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctl.buf;
+    msg.msg_controllen = sizeof ctl.buf;
+    ASSERT_EQ(1, recvmsg(rx.fd(), &msg, 0));
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    ASSERT_TRUE(cm);
+    EXPECT_EQ(SCM_TIMESTAMPNS, cm->cmsg_type);
+}
@@ -0,0 +1,114 @@
+//
+// Created on 10/19/26.
+//
+#include <gtest/gtest.h>
+#include "../src/tmpl_socket.h"
+#include "../src/transport.h"
+#include "../src/shm_transport.h"
+#include "../src/fd_passing.h"
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <vector>
+using namespace bylSocket;
+using bylSocket::Tmpl::Socket;
+using bylSocket::Tmpl::ListenedSocket;
+
+static void echo_roundtrip(TransportKind kind, const char *name) {
+    ListenedSocket<Domain::UNIX> srv(name);
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect(name);
+    auto conn = srv.accept();
+
+    const int N = 2000;
+    std::thread echo([&]() {
+        auto t = make_transport(kind, conn.fd(), false);
+        std::vector<char> buf(1 << 16);
+        for (int i = 0; i < N; ++i) {
+            size_t n = t->recv_frame(buf.data(), buf.size());
+            t->send_frame(buf.data(), n);
+        }
+    });
+    auto t = make_transport(kind, cli.fd(), true);
+    std::vector<char> out(1 << 16), in(1 << 16);
+    for (int i = 0; i < N; ++i) {
+        size_t len = (i * 7919) % 40000;
+        for (size_t k = 0; k < len; ++k)
+            out[k] = (char) (i + k);
+        t->send_frame(out.data(), len);
+        ASSERT_EQ(len, t->recv_frame(in.data(), in.size()));
+        ASSERT_EQ(0, memcmp(out.data(), in.data(), len));
+    }
+    echo.join();
+}
+
+TEST(transport, socket_frames) {
+    echo_roundtrip(TransportKind::SOCKET, "bylsocket_test_transport_sock");
+}
+
+TEST(transport, shm_frames) {
+    echo_roundtrip(TransportKind::SHM, "bylsocket_test_transport_shm");
+}
+
+TEST(transport, shm_peer_gone) {
+    ListenedSocket<Domain::UNIX> srv("bylsocket_test_transport_gone");
+    Socket<Domain::UNIX, Type::STREAM> cli;
+    cli.connect("bylsocket_test_transport_gone");
+    auto conn = srv.accept();
+    auto a = ShmTransport::create(cli.fd());
+    std::unique_ptr<ShmTransport> b = ShmTransport::attach(conn.fd());
+    a->send_frame("x", 1);
+    a.reset();
+    cli = Socket<Domain::UNIX, Type::STREAM>();
+    char c;
+    // queued frames are still delivered after the peer left
+    EXPECT_EQ(1u, b->recv_frame(&c, 1));
+    EXPECT_ANY_THROW(b->recv_frame(&c, 1));
+}
+
+TEST(transport, oversized_frame_skipped) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    {
+        SocketTransport a(sv[0]), b(sv[1]);
+        std::string big(10000, 'b');
+        a.send_frame(big.data(), big.size());
+        a.send_frame("next", 4);
+        char buf[16];
+        EXPECT_ANY_THROW(b.recv_frame(buf, sizeof buf));
+        ASSERT_EQ(4u, b.recv_frame(buf, sizeof buf));
+        EXPECT_EQ(0, memcmp("next", buf, 4));
+    }
+    close(sv[0]);
+    close(sv[1]);
+}
+
+static int open_fds() {
+    int n = 0;
+    for (int fd = 0; fd < 1024; ++fd)
+        if (fcntl(fd, F_GETFD) != -1)
+            ++n;
+    return n;
+}
+
+TEST(transport, shm_attach_malformed) {
+    int sv[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+    int before = open_fds();
+    // too small to hold the ring headers, then a bogus capacity
+    const size_t sizes[] = {16, 1 << 16};
+    for (size_t size : sizes) {
+        int fds[5];
+        fds[0] = memfd_create("bylsocket_test_malformed", MFD_CLOEXEC);
+        ASSERT_EQ(0, ftruncate(fds[0], size));
+        for (int i = 1; i < 5; ++i)
+            fds[i] = eventfd(0, EFD_CLOEXEC);
+        send_fds(sv[0], fds, 5);
+        for (int fd : fds)
+            close(fd);
+        EXPECT_ANY_THROW(ShmTransport::attach(sv[1]));
+        EXPECT_EQ(before, open_fds());
+    }
+    close(sv[0]);
+    close(sv[1]);
+}